@@ -0,0 +1,281 @@
+#include "shasum/pool.hpp"
+#include "shasum/stream_reader.hpp"
+#include "shasum/tree.hpp"
+#include <cthash/sha2/sha256.hpp>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <iterator>
+#include <limits>
+#include <iostream>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// duplicate files are found in stages, so unique files are mostly not read at all:
+// 1) files are grouped by size
+// 2) files of same size are grouped by digest of their first and last 64 KiB
+// 3) only then remaining candidates are hashed completely
+// every file (device and inode) is read at most once, its other names (hard links) are only reported
+
+void print_usage(const char * self) {
+	std::cerr << self << " [-j N] path...\n";
+	std::cerr << "directories are searched recursively, groups of identical files are printed separated by empty line\n";
+}
+
+struct candidate {
+	std::string path;
+	uint64_t size{0};
+	uint64_t device{0};
+	uint64_t inode{0};
+	std::vector<std::string> links{}; // other paths of the same file
+	cthash::sha256_value partial{};
+	cthash::sha256_value full{};
+	bool complete{false}; // partial digest covers whole file
+	bool failed{false};
+};
+
+constexpr size_t edge_size = 64u * 1024u;
+
+// digest of first and last 64 KiB (of whole file when it's small)
+bool hash_edges(candidate & c) {
+	const int fd = open(c.path.c_str(), O_RDONLY | O_CLOEXEC);
+
+	if (fd == -1) {
+		return false;
+	}
+
+	std::vector<std::byte> buffer(2u * edge_size);
+
+	c.complete = c.size <= buffer.size();
+	const size_t head = static_cast<size_t>(std::min<uint64_t>(c.size, c.complete ? buffer.size() : edge_size));
+	const size_t tail = c.complete ? 0u : edge_size;
+
+	const bool success = stream_detail::complete_read(fd, buffer.data(), 0u, head, 0u) && stream_detail::complete_read(fd, buffer.data() + head, 0u, tail, c.size - tail);
+	close(fd);
+
+	if (!success) {
+		return false;
+	}
+
+	c.partial = cthash::sha256{}.update(std::span<const std::byte>(buffer).first(head + tail)).final();
+
+	if (c.complete) {
+		c.full = c.partial;
+	}
+
+	return true;
+}
+
+bool hash_whole(candidate & c, const stream_options & opts) {
+	const int fd = open_for_streaming(c.path.c_str(), false);
+
+	if (fd == -1) {
+		return false;
+	}
+
+	auto h = cthash::sha256{};
+	const bool success = stream_file(fd, c.size, opts, [&](std::span<const std::byte> chunk) { h.update(chunk); });
+	close(fd);
+
+	if (!success) {
+		return false;
+	}
+
+	c.full = h.final();
+	return true;
+}
+
+// run `fn` over all candidates in parallel (largest amount of work first)
+template <typename Fn> void run_stage(std::span<candidate * const> items, unsigned jobs, uint64_t limit, Fn && fn) {
+	std::vector<task> tasks;
+	tasks.reserve(items.size());
+
+	for (size_t i = 0; i != items.size(); ++i) {
+		tasks.push_back(task{i, std::min(items[i]->size, limit)});
+	}
+
+	work_stealing_pool(std::move(tasks), jobs).run([&](const task & t) {
+		candidate & c = *items[t.index];
+
+		if (!fn(c)) {
+			std::cerr << "can't read '" << c.path << "'!\n";
+			c.failed = true;
+		}
+	});
+}
+
+// keep only candidates which have at least one other candidate with same key
+template <typename Key> auto keep_groups(std::vector<candidate *> items, Key && key) -> std::vector<candidate *> {
+	std::erase_if(items, [](const candidate * c) { return c->failed; });
+	std::stable_sort(items.begin(), items.end(), [&](const candidate * lhs, const candidate * rhs) { return key(*lhs) < key(*rhs); });
+
+	std::vector<candidate *> output;
+
+	for (size_t i = 0; i != items.size();) {
+		size_t n = 1u;
+		while (i + n != items.size() && key(*items[i + n]) == key(*items[i])) {
+			++n;
+		}
+
+		if (n > 1u) {
+			output.insert(output.end(), items.begin() + static_cast<std::ptrdiff_t>(i), items.begin() + static_cast<std::ptrdiff_t>(i + n));
+		}
+
+		i += n;
+	}
+
+	return output;
+}
+
+void collect(std::string_view path, unsigned jobs, std::vector<candidate> & output) {
+	struct stat info {};
+
+	if (stat(std::string(path).c_str(), &info) != 0) {
+		std::cerr << "can't read '" << path << "'!\n";
+		return;
+	}
+
+	if (S_ISREG(info.st_mode)) {
+		output.push_back(candidate{std::string(path), static_cast<uint64_t>(info.st_size), static_cast<uint64_t>(info.st_dev), static_cast<uint64_t>(info.st_ino)});
+		return;
+	}
+
+	if (!S_ISDIR(info.st_mode)) {
+		return;
+	}
+
+	auto walker = tree_walker(std::string(path));
+	const auto listing = walker.run(jobs);
+
+	for (const auto & error: listing.errors) {
+		std::cerr << "can't read '" << error << "'!\n";
+	}
+
+	for (const auto & file: listing.files) {
+		output.push_back(candidate{walker.full_path(file.path), file.size, file.device, file.inode});
+	}
+}
+
+// one candidate for each file, same path listed again (overlapping arguments) is dropped and other paths
+// of the same inode are kept as its links, order of candidates is kept
+auto unique_files(std::vector<candidate> & files) -> std::vector<candidate *> {
+	std::vector<candidate *> all;
+	all.reserve(files.size());
+	for (auto & f: files) {
+		all.push_back(&f);
+	}
+
+	std::stable_sort(all.begin(), all.end(), [](const candidate * lhs, const candidate * rhs) { return std::pair(lhs->device, lhs->inode) < std::pair(rhs->device, rhs->inode); });
+
+	std::vector<candidate *> output;
+
+	for (size_t i = 0; i != all.size();) {
+		candidate * first = all[i];
+		size_t n = 1u;
+
+		for (; i + n != all.size() && all[i + n]->device == first->device && all[i + n]->inode == first->inode; ++n) {
+			const std::string & path = all[i + n]->path;
+
+			if (path != first->path && std::find(first->links.begin(), first->links.end(), path) == first->links.end()) {
+				first->links.push_back(path);
+			}
+		}
+
+		output.push_back(first);
+		i += n;
+	}
+
+	// pointers into `files` are in order of arguments and directory listing
+	std::sort(output.begin(), output.end());
+	return output;
+}
+
+int main(int argc, char ** argv) {
+	unsigned jobs = std::max(std::thread::hardware_concurrency(), 1u);
+	int i = 1;
+
+	if (i + 1 < argc && std::string_view(argv[i]) == "-j") {
+		const auto arg = std::string_view(argv[i + 1]);
+		const auto [ptr, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), jobs);
+
+		if (ec != std::errc{} || ptr != arg.data() + arg.size() || jobs == 0u) {
+			print_usage(argv[0]);
+			return 1;
+		}
+
+		i += 2;
+	}
+
+	if (i == argc) {
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	std::vector<candidate> files;
+
+	for (; i < argc; ++i) {
+		collect(argv[i], jobs, files);
+	}
+
+	std::vector<candidate *> items = unique_files(files);
+
+	size_t paths = items.size();
+	for (const candidate * c: items) {
+		paths += c->links.size();
+	}
+
+	// stage 1: size
+	items = keep_groups(std::move(items), [](const candidate & c) { return c.size; });
+
+	// stage 2: first and last 64 KiB
+	run_stage(items, jobs, 2u * edge_size, hash_edges);
+	items = keep_groups(std::move(items), [](const candidate & c) { return std::pair(c.size, c.partial); });
+
+	// stage 3: whole content of files which weren't read completely already
+	std::vector<candidate *> incomplete;
+	std::copy_if(items.begin(), items.end(), std::back_inserter(incomplete), [](const candidate * c) { return !c->complete; });
+
+	const auto opts = stream_options{.buffer_size = 1024u * 1024u};
+	run_stage(incomplete, jobs, std::numeric_limits<uint64_t>::max(), [&](candidate & c) { return hash_whole(c, opts); });
+
+	items = keep_groups(std::move(items), [](const candidate & c) { return std::pair(c.size, c.full); });
+
+	// largest groups (by size of files) first, paths are in order of arguments and directory listing
+	std::stable_sort(items.begin(), items.end(), [](const candidate * lhs, const candidate * rhs) { return std::pair(rhs->size, lhs->full) < std::pair(lhs->size, rhs->full); });
+
+	size_t groups = 0;
+	size_t duplicates = 0;
+	size_t hard_links = 0;
+	uint64_t reclaimable = 0;
+
+	for (size_t j = 0; j != items.size(); ++j) {
+		const bool first = j == 0u || items[j - 1u]->full != items[j]->full || items[j - 1u]->size != items[j]->size;
+
+		if (first) {
+			std::cout << (j != 0u ? "\n" : "") << "# " << items[j]->size << " bytes, sha-256 " << items[j]->full << "\n";
+			++groups;
+		} else {
+			++duplicates;
+			reclaimable += items[j]->size;
+		}
+
+		std::cout << items[j]->path << "\n";
+
+		// removing a hard link doesn't free any space
+		for (const auto & link: items[j]->links) {
+			std::cout << link << "\n";
+			++hard_links;
+		}
+	}
+
+	std::cerr << paths << " file(s), " << groups << " group(s) of identical files, " << duplicates << " duplicate(s), " << reclaimable << " bytes reclaimable\n";
+	std::cerr << hard_links << " hard link(s) in groups (not reclaimable)\n";
+	std::cerr << incomplete.size() << " file(s) had to be read completely\n";
+
+	return 0;
+}
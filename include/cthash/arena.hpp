@@ -0,0 +1,263 @@
+#ifndef CTHASH_ARENA_HPP
+#define CTHASH_ARENA_HPP
+
+#include "batch.hpp"
+#include "internal/assert.hpp"
+#include "internal/lanes.hpp"
+#include <algorithm>
+#include <array>
+#include <span>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace cthash {
+
+// storage for many concurrently open streaming hashers, states, lengths and unprocessed partial blocks
+// are kept in separate pools (structure-of-arrays) and streams are identified by stable handles,
+// batched update collects full blocks of all streams and compresses them together in lanes
+template <internal::batchable_hasher Hasher> struct hasher_arena {
+	using kernel = internal::kernel_of<Hasher>;
+	using engine_t = internal::lanes_engine<kernel>;
+	using state_t = typename kernel::lane_state_t;
+	using result_t = typename Hasher::result_t;
+
+	static constexpr size_t block_size = kernel::block_size_bytes;
+
+	using block_t = std::array<std::byte, block_size>;
+
+	// slot is reused after close, generation distinguishes stale handles of previous streams
+	struct handle {
+		uint32_t index;
+		uint32_t generation;
+
+		constexpr friend bool operator==(handle, handle) noexcept = default;
+	};
+
+	struct update_request {
+		handle stream;
+		std::span<const std::byte> input;
+	};
+
+	// pools (indexed by handle)
+	std::vector<state_t> states;
+	std::vector<uint64_t> lengths; // number of buffered bytes is `length % block_size`
+	std::vector<block_t> blocks;
+	std::vector<uint32_t> batch_marks;
+	std::vector<uint32_t> generations;
+	std::vector<bool> live;
+
+	std::vector<uint32_t> free_handles;
+	uint32_t current_batch{0u};
+
+	constexpr hasher_arena() noexcept = default;
+
+	constexpr explicit hasher_arena(size_t capacity) {
+		reserve(capacity);
+	}
+
+	constexpr void reserve(size_t capacity) {
+		states.reserve(capacity);
+		lengths.reserve(capacity);
+		blocks.reserve(capacity);
+		batch_marks.reserve(capacity);
+		generations.reserve(capacity);
+		live.reserve(capacity);
+	}
+
+	// number of open streams
+	constexpr size_t size() const noexcept {
+		return live.size() - free_handles.size();
+	}
+
+	constexpr bool contains(handle h) const noexcept {
+		return h.index < live.size() && live[h.index] && generations[h.index] == h.generation;
+	}
+
+	[[nodiscard]] constexpr handle open() {
+		if (!free_handles.empty()) {
+			const uint32_t index = free_handles.back();
+			free_handles.pop_back();
+			reset(index);
+			live[index] = true;
+			return handle{index, generations[index]};
+		}
+
+		const auto index = static_cast<uint32_t>(states.size());
+		states.push_back(kernel::initial_lane_state());
+		lengths.push_back(0u);
+		blocks.emplace_back();
+		batch_marks.push_back(0u);
+		generations.push_back(0u);
+		live.push_back(true);
+		return handle{index, 0u};
+	}
+
+	constexpr void close(handle h) {
+		CTHASH_ASSERT(contains(h));
+		live[h.index] = false;
+		++generations[h.index];
+		free_handles.push_back(h.index);
+	}
+
+	// length of the stream in bytes
+	constexpr uint64_t size(handle h) const noexcept {
+		CTHASH_ASSERT(contains(h));
+		return lengths[h.index];
+	}
+
+	constexpr void update(handle h, std::span<const std::byte> input) noexcept {
+		const auto request = update_request{h, input};
+		update(std::span<const update_request>(&request, 1u));
+	}
+
+	// requests are applied in order, the same stream can be in batch multiple times
+	constexpr void update(std::span<const update_request> requests) noexcept {
+		size_t begin = 0u;
+		next_batch();
+
+		for (size_t i = 0u; i != requests.size(); ++i) {
+			const uint32_t index = requests[i].stream.index;
+			CTHASH_ASSERT(contains(requests[i].stream));
+
+			// second update of the same stream must wait for the first one
+			if (batch_marks[index] == current_batch) {
+				process(requests.subspan(begin, i - begin));
+				begin = i;
+				next_batch();
+			}
+
+			batch_marks[index] = current_batch;
+		}
+
+		process(requests.subspan(begin));
+	}
+
+	// write digest and reset the stream so it can be used for another message
+	// (for variable digest length hashers `Result` specifies the length)
+	template <typename Result = result_t> constexpr Result final(handle h) noexcept {
+		CTHASH_ASSERT(contains(h));
+
+		typename engine_t::message_t msg{};
+		msg.start(0u, buffered_input(h.index), states[h.index], prefix_length(h.index));
+		msg.finish_scalar();
+
+		Result output;
+		kernel::write_lane_result_into(msg.state, output);
+		reset(h.index);
+		return output;
+	}
+
+	// finalize multiple streams at once (in lanes)
+	template <typename Result, size_t Extent> constexpr void final(std::span<const handle> streams, std::span<Result, Extent> digests) noexcept {
+		CTHASH_ASSERT(streams.size() == digests.size());
+
+		engine_t engine{};
+
+		const auto finish = [&](const typename engine_t::message_t & msg) {
+			kernel::write_lane_result_into(msg.state, digests[msg.id]);
+			reset(streams[msg.id].index);
+		};
+
+		for (size_t i = 0u; i != streams.size(); ++i) {
+			const uint32_t index = streams[i].index;
+			CTHASH_ASSERT(contains(streams[i]));
+
+			if (engine.full()) {
+				engine.step(finish);
+			}
+
+			engine.start(i, buffered_input(index), states[index], prefix_length(index));
+		}
+
+		engine.drain(finish);
+	}
+
+private:
+	constexpr void reset(uint32_t index) noexcept {
+		states[index] = kernel::initial_lane_state();
+		lengths[index] = 0u;
+	}
+
+	constexpr void next_batch() noexcept {
+		if (++current_batch == 0u) {
+			// after wrap-around old marks could collide
+			std::fill(batch_marks.begin(), batch_marks.end(), 0u);
+			current_batch = 1u;
+		}
+	}
+
+	constexpr size_t buffered(uint32_t index) const noexcept {
+		return static_cast<size_t>(lengths[index] % block_size);
+	}
+
+	constexpr auto buffered_input(uint32_t index) const noexcept -> std::span<const std::byte> {
+		return std::span<const std::byte>(blocks[index]).first(buffered(index));
+	}
+
+	// length of already compressed part
+	constexpr size_t prefix_length(uint32_t index) const noexcept {
+		return static_cast<size_t>(lengths[index]) - buffered(index);
+	}
+
+	// every stream is in `requests` at most once
+	constexpr void process(std::span<const update_request> requests) noexcept {
+		engine_t engine{};
+
+		const auto store = [&](const typename engine_t::message_t & msg) {
+			states[msg.id] = msg.state;
+		};
+
+		const auto schedule = [&](uint32_t index, const std::byte * ptr, size_t count) {
+			if (engine.full()) {
+				engine.step(store);
+			}
+			engine.start_blocks(index, states[index], ptr, count);
+		};
+
+		// first complete partially filled blocks
+		for (const auto & [stream, input]: requests) {
+			const size_t used = buffered(stream.index);
+
+			if (used != 0u && used + input.size() >= block_size) {
+				const size_t missing = block_size - used;
+				std::copy_n(input.data(), missing, blocks[stream.index].data() + used);
+				schedule(stream.index, blocks[stream.index].data(), 1u);
+			}
+		}
+
+		engine.drain(store);
+
+		// then all full blocks directly from inputs
+		for (const auto & [stream, input]: requests) {
+			const size_t used = buffered(stream.index);
+			const size_t skip = (used != 0u) ? std::min(block_size - used, input.size()) : 0u;
+			const auto rest = input.subspan(skip);
+
+			if (const size_t count = rest.size() / block_size; count != 0u) {
+				schedule(stream.index, rest.data(), count);
+			}
+		}
+
+		engine.drain(store);
+
+		// and keep the remainder for next time
+		for (const auto & [stream, input]: requests) {
+			const size_t used = buffered(stream.index);
+
+			if (used != 0u && used + input.size() < block_size) {
+				std::copy(input.begin(), input.end(), blocks[stream.index].begin() + used);
+			} else {
+				const size_t skip = (used != 0u) ? (block_size - used) : 0u;
+				const auto tail = input.subspan(skip + ((input.size() - skip) / block_size) * block_size);
+				std::copy(tail.begin(), tail.end(), blocks[stream.index].begin());
+			}
+
+			lengths[stream.index] += input.size();
+		}
+	}
+};
+
+} // namespace cthash
+
+#endif
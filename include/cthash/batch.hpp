@@ -0,0 +1,89 @@
+#ifndef CTHASH_BATCH_HPP
+#define CTHASH_BATCH_HPP
+
+#include "value.hpp"
+#include "internal/assert.hpp"
+#include "internal/lanes.hpp"
+#include <algorithm>
+#include <array>
+#include <span>
+#include <cstddef>
+
+namespace cthash {
+
+namespace internal {
+
+	template <typename Hasher> using kernel_of = typename Hasher::super;
+
+	template <typename Hasher> concept batchable_hasher = multi_buffer_kernel<kernel_of<Hasher>>;
+
+	template <typename Hasher> concept fixed_digest_hasher = batchable_hasher<Hasher> && (Hasher::result_t::digest_length != 0u);
+
+	// messages are scheduled in windows sorted from longest, so short ones fill the gaps at the end
+	template <typename Hasher, typename Result> constexpr void hash_many_into(std::span<const std::span<const std::byte>> in, std::span<Result> out) noexcept {
+		using kernel = kernel_of<Hasher>;
+		using engine_t = lanes_engine<kernel>;
+
+		CTHASH_ASSERT(in.size() == out.size());
+
+		// with one lane there is nothing to schedule
+		if constexpr (engine_t::lanes == 1u) {
+			for (size_t i = 0; i != in.size(); ++i) {
+				typename engine_t::message_t msg;
+				msg.start(i, in[i]);
+				msg.finish_scalar();
+				kernel::write_lane_result_into(msg.state, out[i]);
+			}
+			return;
+		}
+
+		constexpr size_t window_size = engine_t::lanes * 8u;
+
+		engine_t engine{};
+		std::array<size_t, window_size> window;
+
+		const auto finish = [&](const typename engine_t::message_t & msg) {
+			kernel::write_lane_result_into(msg.state, out[msg.id]);
+		};
+
+		for (size_t offset = 0; offset < in.size(); offset += window_size) {
+			const size_t count = std::min(window_size, in.size() - offset);
+			const auto pending = std::span<size_t>(window).first(count);
+
+			for (size_t i = 0; i != count; ++i) {
+				pending[i] = offset + i;
+			}
+
+			std::sort(pending.begin(), pending.end(), [&](size_t lhs, size_t rhs) {
+				return kernel::padded_blocks_count(in[lhs].size()) > kernel::padded_blocks_count(in[rhs].size());
+			});
+
+			for (size_t id: pending) {
+				if (engine.full()) {
+					engine.step(finish);
+				}
+				engine.start(id, in[id]);
+			}
+		}
+
+		// stragglers
+		engine.drain(finish);
+	}
+
+} // namespace internal
+
+// hash each of input messages into corresponding output, messages are processed in parallel lanes
+template <internal::fixed_digest_hasher Hasher> constexpr void hash_many(std::span<const std::span<const std::byte>> in, std::span<typename Hasher::result_t> out) noexcept {
+	internal::hash_many_into<Hasher>(in, out);
+}
+
+// variant for hashers with variable digest length (SHAKE), length is specified by output type
+template <internal::batchable_hasher Hasher, typename Result, size_t Extent>
+requires(!internal::fixed_digest_hasher<Hasher>)
+constexpr void hash_many(std::span<const std::span<const std::byte>> in, std::span<Result, Extent> out) noexcept {
+	internal::hash_many_into<Hasher>(in, std::span<Result>(out));
+}
+
+} // namespace cthash
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef CTHASH_CDC_HPP
+#define CTHASH_CDC_HPP
+
+#include "batch.hpp"
+#include "internal/assert.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <span>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace cthash {
+
+// content-defined chunking (FastCDC): boundaries are found with gear rolling hash, so they move with
+// content when bytes are inserted or removed, chunks are normalized around average size by using
+// harder mask before average size and easier one after it
+
+struct cdc_config {
+	size_t min_size{2u * 1024u};
+	size_t avg_size{8u * 1024u}; // power of two
+	size_t max_size{64u * 1024u};
+	unsigned normalization{2u};	 // bits added to (removed from) mask before (after) average size
+};
+
+namespace internal {
+
+	// deterministic table of random values (splitmix64)
+	constexpr auto make_gear_table() noexcept -> std::array<uint64_t, 256> {
+		std::array<uint64_t, 256> table{};
+		uint64_t state = 0x9e3779b97f4a7c15ull;
+
+		for (auto & v: table) {
+			state += 0x9e3779b97f4a7c15ull;
+			uint64_t z = state;
+			z = (z ^ (z >> 30u)) * 0xbf58476d1ce4e5b9ull;
+			z = (z ^ (z >> 27u)) * 0x94d049bb133111ebull;
+			v = z ^ (z >> 31u);
+		}
+
+		return table;
+	}
+
+	constexpr auto gear_table = make_gear_table();
+
+	// gear hash shifts one bit per byte, so top bits depend on last bytes of the window
+	constexpr uint64_t top_bits_mask(unsigned bits) noexcept {
+		return (bits == 0u) ? 0u : (~uint64_t{0} << (64u - std::min(bits, 64u)));
+	}
+
+} // namespace internal
+
+// progress of boundary search in data which didn't contain boundary yet, so search can continue when
+// more data is appended instead of hashing the same bytes again
+struct cdc_scan {
+	size_t position{0u};
+	uint64_t hash{0u};
+};
+
+struct fastcdc {
+	cdc_config config;
+	uint64_t mask_small; // used before average size (harder to match)
+	uint64_t mask_large; // used after average size
+
+	explicit constexpr fastcdc(cdc_config cfg = {}) noexcept: config{cfg} {
+		CTHASH_ASSERT(config.min_size != 0u && config.min_size <= config.avg_size && config.avg_size <= config.max_size);
+
+		const auto bits = static_cast<unsigned>(std::bit_width(config.avg_size) - 1u);
+		mask_small = internal::top_bits_mask(bits + config.normalization);
+		mask_large = internal::top_bits_mask(bits > config.normalization ? bits - config.normalization : 1u);
+	}
+
+	// length of chunk starting at beginning of data, zero when there is not enough data to decide
+	// (unless it's the end of input, then rest of the data is the chunk)
+	constexpr size_t cut(std::span<const std::byte> data, bool end_of_input = false) const noexcept {
+		auto scan = cdc_scan{};
+		return cut(data, end_of_input, scan);
+	}
+
+	// same as above, but search continues from `scan` (data must start with the same bytes as in previous
+	// call), when no boundary is found `scan` is updated to the end of data, otherwise it's reset
+	constexpr size_t cut(std::span<const std::byte> data, bool end_of_input, cdc_scan & scan) const noexcept {
+		const size_t available = std::min(data.size(), config.max_size);
+
+		if (available <= config.min_size) {
+			return (end_of_input || available == config.max_size) ? available : 0u;
+		}
+
+		const size_t normal = std::min(config.avg_size, available);
+		const std::byte * ptr = data.data();
+
+		uint64_t hash = scan.hash;
+
+		// boundary can't be inside first `min_size` bytes, so they are skipped completely
+		size_t i = std::max(scan.position, config.min_size);
+
+		for (; i < normal; ++i) {
+			hash = (hash << 1u) + internal::gear_table[std::to_integer<uint8_t>(ptr[i])];
+			if ((hash & mask_small) == 0u) {
+				scan = {};
+				return i + 1u;
+			}
+		}
+
+		for (; i < available; ++i) {
+			hash = (hash << 1u) + internal::gear_table[std::to_integer<uint8_t>(ptr[i])];
+			if ((hash & mask_large) == 0u) {
+				scan = {};
+				return i + 1u;
+			}
+		}
+
+		if (end_of_input || available == config.max_size) {
+			scan = {};
+			return available;
+		}
+
+		scan = {i, hash};
+		return 0u;
+	}
+};
+
+template <typename Result> struct chunk_record {
+	uint64_t offset;
+	size_t length;
+	Result digest;
+
+	constexpr friend bool operator==(const chunk_record &, const chunk_record &) noexcept = default;
+};
+
+// splits stream into content-defined chunks and hashes them, complete chunks found in one update are
+// hashed together in multi-buffer lanes and given to callback in order as `chunk_record`
+template <internal::fixed_digest_hasher Hasher> struct chunked_hasher {
+	using result_t = typename Hasher::result_t;
+	using record_t = chunk_record<result_t>;
+
+	static constexpr size_t max_batch = 64u;
+
+	fastcdc chunker;
+	uint64_t offset{0u};
+
+	// beginning of a chunk which was split by end of previous update
+	std::vector<std::byte> pending{};
+	cdc_scan scan{};
+
+	// chunks waiting to be hashed
+	std::vector<std::span<const std::byte>> batch{};
+	std::vector<result_t> results{};
+
+	explicit constexpr chunked_hasher(cdc_config config = {}): chunker{config} {
+		batch.reserve(max_batch);
+		results.resize(max_batch);
+	}
+
+	template <typename Fn> constexpr chunked_hasher & update(std::span<const std::byte> in, Fn && emit) {
+		process(in, false, emit);
+		return *this;
+	}
+
+	// emits the last chunk
+	template <typename Fn> constexpr void final(Fn && emit) {
+		process({}, true, emit);
+	}
+
+private:
+	template <typename Fn> constexpr void flush(Fn & emit) {
+		const auto r = std::span(results).first(batch.size());
+		hash_many<Hasher>(batch, r);
+
+		for (size_t i = 0; i != batch.size(); ++i) {
+			emit(record_t{offset, batch[i].size(), r[i]});
+			offset += batch[i].size();
+		}
+
+		batch.clear();
+	}
+
+	template <typename Fn> constexpr void add(std::span<const std::byte> chunk, Fn & emit) {
+		batch.push_back(chunk);
+
+		if (batch.size() == max_batch) {
+			flush(emit);
+		}
+	}
+
+	template <typename Fn> constexpr void process(std::span<const std::byte> in, bool end, Fn & emit) {
+		// chunk started in previous update is completed by copying beginning of input to it, boundary can't
+		// be inside already pending bytes (no boundary was found there) so they are always consumed and only
+		// appended bytes are scanned, pending chunk stays in batch with others until the end of this update
+		if (!pending.empty()) {
+			const size_t before = pending.size();
+			const size_t n = std::min(in.size(), chunker.config.max_size - before);
+			pending.insert(pending.end(), in.begin(), in.begin() + static_cast<std::ptrdiff_t>(n));
+
+			const size_t length = chunker.cut(pending, end && n == in.size(), scan);
+
+			if (length == 0u) {
+				return;
+			}
+
+			CTHASH_ASSERT(length >= before);
+
+			add(std::span<const std::byte>(pending).first(length), emit);
+			in = in.subspan(length - before);
+		}
+
+		// chunks inside input are not copied
+		while (!in.empty()) {
+			const size_t length = chunker.cut(in, end, scan);
+
+			if (length == 0u) {
+				break;
+			}
+
+			add(in.first(length), emit);
+			in = in.subspan(length);
+		}
+
+		flush(emit);
+		pending.assign(in.begin(), in.end());
+	}
+};
+
+// all chunks of input with their digests
+template <internal::fixed_digest_hasher Hasher> constexpr auto chunk_digests(std::span<const std::byte> input, cdc_config config = {}) -> std::vector<chunk_record<typename Hasher::result_t>> {
+	std::vector<chunk_record<typename Hasher::result_t>> output;
+	const auto emit = [&](const auto & record) { output.push_back(record); };
+
+	auto h = chunked_hasher<Hasher>{config};
+	h.update(input, emit);
+	h.final(emit);
+	return output;
+}
+
+} // namespace cthash
+
+#endif
@@ -7,6 +7,7 @@
 #include "sha2/sha384.hpp"
 #include "sha2/sha512.hpp"
 #include "sha2/sha512/t.hpp"
+#include "sha2/compress.hpp"
 
 // SHA-3 (keccak) family
 #include "sha3/sha3-224.hpp"
@@ -16,4 +17,23 @@
 #include "sha3/shake128.hpp"
 #include "sha3/shake256.hpp"
 
+// runtime parsing and encodings of digests
+#include "parse.hpp"
+#include "encoding.hpp"
+
+// containers keyed by digests
+#include "digest_map.hpp"
+
+// multi-buffer processing
+#include "batch.hpp"
+#include "job_manager.hpp"
+
+// multiple digests in one pass
+#include "multi_hasher.hpp"
+#include "dual_digest.hpp"
+
+// content-defined chunking and delta transfer
+#include "cdc.hpp"
+#include "delta.hpp"
+
 #endif
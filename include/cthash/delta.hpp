@@ -0,0 +1,335 @@
+#ifndef CTHASH_DELTA_HPP
+#define CTHASH_DELTA_HPP
+
+#include "batch.hpp"
+#include "value.hpp"
+#include "internal/assert.hpp"
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace cthash {
+
+// rsync-style delta: old file is described by signature (weak rolling checksum and truncated strong digest of
+// each block), new file is scanned with rolling checksum and candidates are confirmed with strong digest
+
+// weak checksum of rsync: s1 is sum of bytes, s2 is sum of s1 after each byte (both mod 2^16), window
+// can be moved by one byte in constant time
+struct rolling_checksum {
+	uint32_t s1{0u};
+	uint32_t s2{0u};
+	uint32_t length{0u};
+
+	constexpr rolling_checksum() noexcept = default;
+	explicit constexpr rolling_checksum(std::span<const std::byte> window) noexcept {
+		reset(window);
+	}
+
+	constexpr void reset(std::span<const std::byte> window) noexcept {
+		s1 = 0u;
+		s2 = 0u;
+		length = static_cast<uint32_t>(window.size());
+
+		for (std::byte b: window) {
+			s1 += std::to_integer<uint32_t>(b);
+			s2 += s1;
+		}
+	}
+
+	// remove first byte of window and append new one
+	constexpr void roll(std::byte out, std::byte in) noexcept {
+		s1 += std::to_integer<uint32_t>(in) - std::to_integer<uint32_t>(out);
+		s2 += s1 - length * std::to_integer<uint32_t>(out);
+	}
+
+	constexpr uint32_t value() const noexcept {
+		return (s1 & 0xFFFFu) | (s2 << 16u);
+	}
+};
+
+template <size_t StrongLength = 16u> struct block_signature {
+	uint32_t weak;
+	hash_value<StrongLength> strong;
+
+	constexpr friend bool operator==(const block_signature &, const block_signature &) noexcept = default;
+};
+
+// all blocks have same size, except the last one which can be shorter
+template <size_t StrongLength = 16u> struct file_signature {
+	size_t block_size;
+	uint64_t size;
+	std::vector<block_signature<StrongLength>> blocks;
+};
+
+// `copy` takes `length` bytes at `offset` of old file, otherwise it's literal from `offset` of new data
+struct delta_op {
+	bool copy;
+	uint64_t offset;
+	size_t length;
+
+	constexpr friend bool operator==(const delta_op &, const delta_op &) noexcept = default;
+};
+
+namespace internal {
+
+	template <size_t StrongLength, typename Result> constexpr auto truncate_digest(const Result & in) noexcept -> hash_value<StrongLength> {
+		static_assert(StrongLength <= Result::digest_length);
+
+		hash_value<StrongLength> output{};
+		std::copy_n(in.begin(), StrongLength, output.begin());
+		return output;
+	}
+
+	template <size_t StrongLength, typename Result> constexpr bool same_prefix(const hash_value<StrongLength> & lhs, const Result & rhs) noexcept {
+		return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+
+} // namespace internal
+
+// strong digests of blocks are computed together in multi-buffer lanes
+template <internal::fixed_digest_hasher Hasher, size_t StrongLength = 16u> constexpr auto make_signature(std::span<const std::byte> data, size_t block_size) -> file_signature<StrongLength> {
+	CTHASH_ASSERT(block_size != 0u);
+
+	using result_t = typename Hasher::result_t;
+	constexpr size_t batch = 256u;
+
+	file_signature<StrongLength> output{block_size, data.size(), {}};
+	output.blocks.resize((data.size() + block_size - 1u) / block_size);
+
+	std::vector<std::span<const std::byte>> spans;
+	std::vector<result_t> results(batch);
+
+	for (size_t first = 0; first < output.blocks.size(); first += batch) {
+		const size_t count = std::min(batch, output.blocks.size() - first);
+		spans.clear();
+
+		for (size_t i = 0; i != count; ++i) {
+			const size_t offset = (first + i) * block_size;
+			const auto block = data.subspan(offset, std::min(block_size, data.size() - offset));
+
+			output.blocks[first + i].weak = rolling_checksum(block).value();
+			spans.push_back(block);
+		}
+
+		hash_many<Hasher>(spans, std::span(results).first(count));
+
+		for (size_t i = 0; i != count; ++i) {
+			output.blocks[first + i].strong = internal::truncate_digest<StrongLength>(results[i]);
+		}
+	}
+
+	return output;
+}
+
+// finds blocks of old file (described by signature) in new data, signature must outlive the matcher
+template <internal::fixed_digest_hasher Hasher, size_t StrongLength = 16u> struct delta_matcher {
+	using result_t = typename Hasher::result_t;
+
+	static constexpr size_t max_candidates = 64u;
+	static constexpr unsigned filter_bits = 20u;
+
+	const file_signature<StrongLength> * signature;
+
+	// full blocks sorted by weak checksum
+	std::vector<std::pair<uint32_t, size_t>> index{};
+
+	// bitmap of present weak checksums, most positions are rejected without searching in index
+	std::vector<uint64_t> filter = std::vector<uint64_t>((size_t{1} << filter_bits) / 64u);
+
+	explicit constexpr delta_matcher(const file_signature<StrongLength> & sig): signature{&sig} {
+		CTHASH_ASSERT(sig.block_size != 0u);
+
+		index.reserve(sig.blocks.size());
+
+		for (size_t i = 0; i != sig.blocks.size(); ++i) {
+			if (block_length(i) != sig.block_size) {
+				continue;
+			}
+
+			const uint32_t weak = sig.blocks[i].weak;
+			index.emplace_back(weak, i);
+			filter[filter_slot(weak) / 64u] |= uint64_t{1} << (filter_slot(weak) % 64u);
+		}
+
+		std::sort(index.begin(), index.end());
+	}
+
+	// copy and literal operations which create `data` from old file
+	constexpr auto match(std::span<const std::byte> data) const -> std::vector<delta_op> {
+		std::vector<delta_op> output;
+		const size_t block_size = signature->block_size;
+
+		// candidate windows of one round, each found with assumption that previous ones will be confirmed
+		std::vector<std::pair<size_t, size_t>> candidates; // (position, first index entry)
+		std::vector<std::span<const std::byte>> windows;
+		std::vector<size_t> unknown; // candidates which are hashed in this round
+		std::vector<result_t> hashed(max_candidates);
+		std::vector<result_t> results(max_candidates);
+
+		// digests of candidates after a failed one stay valid, they are reused when scanning reaches them again
+		std::vector<std::pair<size_t, result_t>> known;
+		size_t next_known = 0u;
+
+		size_t done = 0u; // data before this position is already in output
+		size_t position = 0u;
+
+		while (position + block_size <= data.size()) {
+			candidates.clear();
+			windows.clear();
+			unknown.clear();
+
+			auto weak = rolling_checksum(data.subspan(position, block_size));
+
+			while (candidates.size() != max_candidates) {
+				if (const auto it = find(weak.value()); it != index.end()) {
+					while (next_known != known.size() && known[next_known].first < position) {
+						++next_known;
+					}
+
+					if (next_known != known.size() && known[next_known].first == position) {
+						results[candidates.size()] = known[next_known].second;
+					} else {
+						unknown.push_back(candidates.size());
+						windows.push_back(data.subspan(position, block_size));
+					}
+
+					candidates.emplace_back(position, static_cast<size_t>(it - index.begin()));
+
+					position += block_size;
+
+					if (position + block_size > data.size()) {
+						break;
+					}
+
+					weak.reset(data.subspan(position, block_size));
+					continue;
+				}
+
+				if (position + block_size == data.size()) {
+					position = data.size();
+					break;
+				}
+
+				weak.roll(data[position], data[position + block_size]);
+				++position;
+			}
+
+			hash_many<Hasher>(windows, std::span(hashed).first(windows.size()));
+
+			for (size_t i = 0; i != unknown.size(); ++i) {
+				results[unknown[i]] = hashed[i];
+			}
+
+			for (size_t i = 0; i != candidates.size(); ++i) {
+				const auto [at, first] = candidates[i];
+				const auto block = confirm(first, results[i]);
+
+				if (!block) {
+					// rest of candidates was found with wrong assumption, scanning continues after failed one
+					remember(known, next_known, at, std::span(candidates).subspan(i + 1u), std::span(results).subspan(i + 1u));
+					position = at + 1u;
+					break;
+				}
+
+				add_literal(output, done, at);
+				add_copy(output, *block * block_size, block_size);
+				done = at + block_size;
+			}
+		}
+
+		// shorter last block can be only at end of data
+		if (const size_t last = signature->blocks.size(); last != 0u && block_length(last - 1u) != block_size) {
+			const size_t length = block_length(last - 1u);
+			const auto & expected = signature->blocks[last - 1u];
+
+			if (data.size() - done >= length) {
+				const auto tail = data.last(length);
+
+				if (rolling_checksum(tail).value() == expected.weak && internal::same_prefix(expected.strong, Hasher{}.update(tail).final())) {
+					add_literal(output, done, data.size() - length);
+					add_copy(output, (last - 1u) * block_size, length);
+					done = data.size();
+				}
+			}
+		}
+
+		add_literal(output, done, data.size());
+		return output;
+	}
+
+private:
+	constexpr size_t block_length(size_t i) const noexcept {
+		const uint64_t offset = i * signature->block_size;
+		return static_cast<size_t>(std::min<uint64_t>(signature->block_size, signature->size - offset));
+	}
+
+	static constexpr size_t filter_slot(uint32_t weak) noexcept {
+		return (weak * 0x9E3779B1u) >> (32u - filter_bits);
+	}
+
+	constexpr auto find(uint32_t weak) const noexcept {
+		if (((filter[filter_slot(weak) / 64u] >> (filter_slot(weak) % 64u)) & 1u) == 0u) {
+			return index.end();
+		}
+
+		const auto it = std::lower_bound(index.begin(), index.end(), weak, [](const auto & entry, uint32_t value) { return entry.first < value; });
+		return (it != index.end() && it->first == weak) ? it : index.end();
+	}
+
+	// first block with same weak checksum and strong digest
+	constexpr auto confirm(size_t first, const result_t & digest) const noexcept -> std::optional<size_t> {
+		for (size_t i = first; i != index.size() && index[i].first == index[first].first; ++i) {
+			if (internal::same_prefix(signature->blocks[index[i].second].strong, digest)) {
+				return index[i].second;
+			}
+		}
+
+		return std::nullopt;
+	}
+
+	// digests after `at` are kept sorted by position (each position is hashed at most once)
+	static constexpr void remember(std::vector<std::pair<size_t, result_t>> & known, size_t & next_known, size_t at, std::span<const std::pair<size_t, size_t>> candidates, std::span<const result_t> results) {
+		next_known = 0u;
+
+		std::erase_if(known, [at](const auto & entry) { return entry.first <= at; });
+
+		for (size_t i = 0; i != candidates.size(); ++i) {
+			known.emplace_back(candidates[i].first, results[i]);
+		}
+
+		std::sort(known.begin(), known.end(), [](const auto & lhs, const auto & rhs) { return lhs.first < rhs.first; });
+		known.erase(std::unique(known.begin(), known.end(), [](const auto & lhs, const auto & rhs) { return lhs.first == rhs.first; }), known.end());
+	}
+
+	static constexpr void add_literal(std::vector<delta_op> & output, size_t from, size_t to) {
+		if (from == to) {
+			return;
+		}
+
+		if (!output.empty() && !output.back().copy) {
+			output.back().length += to - from;
+			return;
+		}
+
+		output.push_back(delta_op{false, from, to - from});
+	}
+
+	// consecutive blocks are joined into one copy
+	static constexpr void add_copy(std::vector<delta_op> & output, uint64_t offset, size_t length) {
+		if (!output.empty() && output.back().copy && output.back().offset + output.back().length == offset) {
+			output.back().length += length;
+			return;
+		}
+
+		output.push_back(delta_op{true, offset, length});
+	}
+};
+
+} // namespace cthash
+
+#endif
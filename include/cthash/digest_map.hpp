@@ -0,0 +1,433 @@
+#ifndef CTHASH_DIGEST_MAP_HPP
+#define CTHASH_DIGEST_MAP_HPP
+
+#include "value.hpp"
+#include "internal/algorithm.hpp"
+#include "internal/assert.hpp"
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+namespace cthash {
+
+namespace internal {
+
+	// open addressing table (swiss table): slots are in groups of 16 with one control byte per slot, control
+	// byte of full slot is 7 bits of digest, so whole group is checked with one comparison and keys are
+	// compared only on match, position and control byte come from digest itself (no hashing)
+	template <typename Key, typename Slot> struct digest_table {
+		static constexpr size_t group_size = 16u;
+		static constexpr size_t npos = static_cast<size_t>(-1);
+
+		static constexpr uint8_t ctrl_empty = 0x80u;
+		static constexpr uint8_t ctrl_deleted = 0xFEu;
+
+		std::vector<uint8_t> ctrl{};
+		std::vector<Slot> slots{};
+		size_t count{0u};
+		size_t tombstones{0u};
+
+		static constexpr const Key & key_of(const Slot & slot) noexcept {
+			if constexpr (std::same_as<Slot, Key>) {
+				return slot;
+			} else {
+				return slot.first;
+			}
+		}
+
+		static constexpr uint64_t hash_of(const Key & key) noexcept {
+			return prefix_word<Key::digest_length>(key.data());
+		}
+
+		// top bits are independent of bits used for position (unless there are 2^57 groups)
+		static constexpr uint8_t tag_of(uint64_t hash) noexcept {
+			return static_cast<uint8_t>(hash >> 57u);
+		}
+
+		// bit for each slot of group with control byte equal to `value`
+		static constexpr uint32_t match(const uint8_t * group, uint8_t value) noexcept {
+#ifdef __SSE2__
+			if (!std::is_constant_evaluated()) {
+				const __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+				return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(static_cast<char>(value)))));
+			}
+#endif
+			uint32_t output = 0u;
+			for (size_t i = 0; i != group_size; ++i) {
+				output |= static_cast<uint32_t>(group[i] == value) << i;
+			}
+			return output;
+		}
+
+		// empty and deleted slots have top bit set
+		static constexpr uint32_t match_free(const uint8_t * group) noexcept {
+#ifdef __SSE2__
+			if (!std::is_constant_evaluated()) {
+				return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(group))));
+			}
+#endif
+			uint32_t output = 0u;
+			for (size_t i = 0; i != group_size; ++i) {
+				output |= static_cast<uint32_t>(group[i] >> 7u) << i;
+			}
+			return output;
+		}
+
+		constexpr size_t capacity() const noexcept {
+			return ctrl.size();
+		}
+
+		constexpr bool is_full(size_t i) const noexcept {
+			return (ctrl[i] & 0x80u) == 0u;
+		}
+
+		// groups are visited in triangular sequence (it covers all of them for power of two count)
+		template <typename Fn> constexpr size_t probe(uint64_t hash, Fn && fn) const noexcept {
+			const size_t mask = ctrl.size() / group_size - 1u;
+			size_t group = static_cast<size_t>(hash) & mask;
+
+			for (size_t step = 1u;; ++step) {
+				if (const size_t r = fn(group * group_size); r != npos) {
+					return r;
+				}
+				group = (group + step) & mask;
+			}
+		}
+
+		constexpr size_t find(const Key & key) const noexcept {
+			if (count == 0u) {
+				return npos;
+			}
+
+			const uint64_t hash = hash_of(key);
+			const uint8_t tag = tag_of(hash);
+			bool missing = false;
+
+			const size_t r = probe(hash, [&](size_t first) {
+				for (uint32_t m = match(ctrl.data() + first, tag); m != 0u; m &= m - 1u) {
+					const size_t i = first + static_cast<size_t>(std::countr_zero(m));
+					if (key_of(slots[i]) == key) {
+						return i;
+					}
+				}
+
+				// key would be in first group with empty slot
+				missing = match(ctrl.data() + first, ctrl_empty) != 0u;
+				return missing ? size_t{0} : npos;
+			});
+
+			return missing ? npos : r;
+		}
+
+		constexpr size_t find_free(uint64_t hash) const noexcept {
+			return probe(hash, [&](size_t first) {
+				const uint32_t m = match_free(ctrl.data() + first);
+				return (m != 0u) ? first + static_cast<size_t>(std::countr_zero(m)) : npos;
+			});
+		}
+
+		// slot with the key (which needs to be filled if it was inserted)
+		constexpr auto find_or_insert(const Key & key) -> std::pair<size_t, bool> {
+			if (const size_t i = find(key); i != npos) {
+				return {i, false};
+			}
+
+			// load factor is at most 7/8
+			if ((count + tombstones + 1u) * 8u > capacity() * 7u) {
+				rehash(((count + 1u) * 16u > capacity() * 7u) ? std::max(capacity() * 2u, group_size) : capacity());
+			}
+
+			const uint64_t hash = hash_of(key);
+			const size_t i = find_free(hash);
+
+			tombstones -= (ctrl[i] == ctrl_deleted);
+			ctrl[i] = tag_of(hash);
+			++count;
+
+			return {i, true};
+		}
+
+		constexpr void erase_at(size_t i) {
+			CTHASH_ASSERT(is_full(i));
+
+			// probing never continues after group with empty slot, so tombstone isn't needed there
+			const bool has_empty = match(ctrl.data() + (i / group_size) * group_size, ctrl_empty) != 0u;
+			ctrl[i] = has_empty ? ctrl_empty : ctrl_deleted;
+			tombstones += !has_empty;
+
+			slots[i] = Slot{};
+			--count;
+		}
+
+		constexpr void rehash(size_t new_capacity) {
+			CTHASH_ASSERT(std::has_single_bit(new_capacity) && new_capacity >= group_size);
+			CTHASH_ASSERT(count * 8u <= new_capacity * 7u);
+
+			auto old_ctrl = std::exchange(ctrl, std::vector<uint8_t>(new_capacity, ctrl_empty));
+			auto old_slots = std::exchange(slots, std::vector<Slot>(new_capacity));
+			tombstones = 0u;
+
+			for (size_t i = 0; i != old_ctrl.size(); ++i) {
+				if ((old_ctrl[i] & 0x80u) != 0u) {
+					continue;
+				}
+
+				const uint64_t hash = hash_of(key_of(old_slots[i]));
+				const size_t j = find_free(hash);
+				ctrl[j] = tag_of(hash);
+				slots[j] = std::move(old_slots[i]);
+			}
+		}
+
+		constexpr void reserve(size_t n) {
+			const size_t needed = std::max(std::bit_ceil((n * 8u + 6u) / 7u), group_size);
+
+			if (needed > capacity()) {
+				rehash(needed);
+			}
+		}
+
+		constexpr void clear() noexcept {
+			ctrl.clear();
+			slots.clear();
+			count = 0u;
+			tombstones = 0u;
+		}
+
+		constexpr size_t next_full(size_t i) const noexcept {
+			while (i != ctrl.size() && !is_full(i)) {
+				++i;
+			}
+			return i;
+		}
+	};
+
+	template <typename Table, typename Value> struct digest_table_iterator {
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = std::remove_const_t<Value>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = Value *;
+		using reference = Value &;
+
+		Table * table{nullptr};
+		size_t index{0u};
+
+		constexpr reference operator*() const noexcept {
+			return table->slots[index];
+		}
+
+		constexpr pointer operator->() const noexcept {
+			return &table->slots[index];
+		}
+
+		constexpr digest_table_iterator & operator++() noexcept {
+			index = table->next_full(index + 1u);
+			return *this;
+		}
+
+		constexpr digest_table_iterator operator++(int) noexcept {
+			auto copy = *this;
+			++*this;
+			return copy;
+		}
+
+		constexpr friend bool operator==(const digest_table_iterator & lhs, const digest_table_iterator & rhs) noexcept {
+			return lhs.index == rhs.index;
+		}
+	};
+
+} // namespace internal
+
+// set of digests with flat layout (no allocation per entry)
+template <typename Tag> struct digest_set {
+	using key_type = tagged_hash_value<Tag>;
+	using value_type = key_type;
+	using table_t = internal::digest_table<key_type, key_type>;
+	using iterator = internal::digest_table_iterator<const table_t, const value_type>;
+	using const_iterator = iterator;
+
+	table_t table{};
+
+	constexpr digest_set() noexcept = default;
+
+	constexpr explicit digest_set(size_t capacity) {
+		reserve(capacity);
+	}
+
+	constexpr size_t size() const noexcept {
+		return table.count;
+	}
+
+	constexpr bool empty() const noexcept {
+		return table.count == 0u;
+	}
+
+	constexpr size_t capacity() const noexcept {
+		return table.capacity();
+	}
+
+	constexpr void reserve(size_t n) {
+		table.reserve(n);
+	}
+
+	constexpr void clear() noexcept {
+		table.clear();
+	}
+
+	constexpr auto insert(const key_type & key) -> std::pair<iterator, bool> {
+		const auto [i, inserted] = table.find_or_insert(key);
+
+		if (inserted) {
+			table.slots[i] = key;
+		}
+
+		return {iterator{&table, i}, inserted};
+	}
+
+	constexpr bool contains(const key_type & key) const noexcept {
+		return table.find(key) != table_t::npos;
+	}
+
+	constexpr size_t count(const key_type & key) const noexcept {
+		return contains(key) ? 1u : 0u;
+	}
+
+	constexpr auto find(const key_type & key) const noexcept -> iterator {
+		const size_t i = table.find(key);
+		return (i != table_t::npos) ? iterator{&table, i} : end();
+	}
+
+	constexpr size_t erase(const key_type & key) {
+		const size_t i = table.find(key);
+
+		if (i == table_t::npos) {
+			return 0u;
+		}
+
+		table.erase_at(i);
+		return 1u;
+	}
+
+	constexpr auto begin() const noexcept -> iterator {
+		return iterator{&table, table.next_full(0u)};
+	}
+
+	constexpr auto end() const noexcept -> iterator {
+		return iterator{&table, table.capacity()};
+	}
+};
+
+// map from digest with flat layout (no allocation per entry), mapped type must be default constructible
+template <typename Tag, typename T> struct digest_map {
+	using key_type = tagged_hash_value<Tag>;
+	using mapped_type = T;
+	using value_type = std::pair<key_type, T>;
+	using table_t = internal::digest_table<key_type, value_type>;
+	using iterator = internal::digest_table_iterator<table_t, value_type>;
+	using const_iterator = internal::digest_table_iterator<const table_t, const value_type>;
+
+	table_t table{};
+
+	constexpr digest_map() noexcept = default;
+
+	constexpr explicit digest_map(size_t capacity) {
+		reserve(capacity);
+	}
+
+	constexpr size_t size() const noexcept {
+		return table.count;
+	}
+
+	constexpr bool empty() const noexcept {
+		return table.count == 0u;
+	}
+
+	constexpr size_t capacity() const noexcept {
+		return table.capacity();
+	}
+
+	constexpr void reserve(size_t n) {
+		table.reserve(n);
+	}
+
+	constexpr void clear() noexcept {
+		table.clear();
+	}
+
+	template <typename... Args> constexpr auto try_emplace(const key_type & key, Args &&... args) -> std::pair<iterator, bool> {
+		const auto [i, inserted] = table.find_or_insert(key);
+
+		if (inserted) {
+			table.slots[i] = value_type{key, T(std::forward<Args>(args)...)};
+		}
+
+		return {iterator{&table, i}, inserted};
+	}
+
+	template <typename M> constexpr auto insert_or_assign(const key_type & key, M && value) -> std::pair<iterator, bool> {
+		auto r = try_emplace(key);
+		r.first->second = std::forward<M>(value);
+		return r;
+	}
+
+	constexpr T & operator[](const key_type & key) {
+		return try_emplace(key).first->second;
+	}
+
+	constexpr bool contains(const key_type & key) const noexcept {
+		return table.find(key) != table_t::npos;
+	}
+
+	constexpr size_t count(const key_type & key) const noexcept {
+		return contains(key) ? 1u : 0u;
+	}
+
+	constexpr auto find(const key_type & key) noexcept -> iterator {
+		const size_t i = table.find(key);
+		return (i != table_t::npos) ? iterator{&table, i} : end();
+	}
+
+	constexpr auto find(const key_type & key) const noexcept -> const_iterator {
+		const size_t i = table.find(key);
+		return (i != table_t::npos) ? const_iterator{&table, i} : end();
+	}
+
+	constexpr size_t erase(const key_type & key) {
+		const size_t i = table.find(key);
+
+		if (i == table_t::npos) {
+			return 0u;
+		}
+
+		table.erase_at(i);
+		return 1u;
+	}
+
+	constexpr auto begin() noexcept -> iterator {
+		return iterator{&table, table.next_full(0u)};
+	}
+
+	constexpr auto end() noexcept -> iterator {
+		return iterator{&table, table.capacity()};
+	}
+
+	constexpr auto begin() const noexcept -> const_iterator {
+		return const_iterator{&table, table.next_full(0u)};
+	}
+
+	constexpr auto end() const noexcept -> const_iterator {
+		return const_iterator{&table, table.capacity()};
+	}
+};
+
+} // namespace cthash
+
+#endif
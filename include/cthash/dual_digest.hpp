@@ -0,0 +1,205 @@
+#ifndef CTHASH_DUAL_DIGEST_HPP
+#define CTHASH_DUAL_DIGEST_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <memory>
+#include <optional>
+#include <span>
+#include <thread>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+namespace cthash {
+
+// result of one step of a streaming decoder (inflate-like interface)
+struct decode_step {
+	size_t consumed{0u};
+	size_t produced{0u};
+	bool error{false};
+};
+
+// decoder consumes part of input and produces part of output, it's called with empty input at the
+// end of the stream until it doesn't fill whole output (so buffered output can be flushed), decoder
+// which doesn't accept more input (data after end of stream) makes no progress
+template <typename T> concept stream_decoder = requires(T & decoder, std::span<const std::byte> in, std::span<std::byte> out) {
+	{ decoder.decode(in, out) } -> std::same_as<decode_step>;
+	{ decoder.finished() } -> std::convertible_to<bool>;
+};
+
+// bounded buffer between one producer and one consumer thread
+struct byte_ring {
+	// closing is part of written position, so consumer waiting for data is woken up by it
+	static constexpr size_t closed_bit = size_t{1} << (sizeof(size_t) * 8u - 1u);
+
+	std::unique_ptr<std::byte[]> storage;
+	size_t capacity;
+
+	// monotonic positions (modulo capacity is the index)
+	alignas(64) std::atomic<size_t> written{0u};
+	alignas(64) std::atomic<size_t> read{0u};
+
+	explicit byte_ring(size_t cap): storage{std::make_unique<std::byte[]>(std::bit_ceil(cap))}, capacity{std::bit_ceil(cap)} { }
+
+	byte_ring(const byte_ring &) = delete;
+	byte_ring & operator=(const byte_ring &) = delete;
+
+	// contiguous free space, waits until there is some
+	auto writable() noexcept -> std::span<std::byte> {
+		const size_t w = written.load(std::memory_order_relaxed) & ~closed_bit;
+		size_t r = read.load(std::memory_order_acquire);
+
+		while (w - r == capacity) {
+			read.wait(r, std::memory_order_acquire);
+			r = read.load(std::memory_order_acquire);
+		}
+
+		const size_t offset = w & (capacity - 1u);
+		return std::span<std::byte>(storage.get() + offset, std::min(capacity - (w - r), capacity - offset));
+	}
+
+	void commit(size_t n) noexcept {
+		if (n != 0u) {
+			written.fetch_add(n, std::memory_order_release);
+			written.notify_one();
+		}
+	}
+
+	void close() noexcept {
+		written.fetch_or(closed_bit, std::memory_order_release);
+		written.notify_one();
+	}
+
+	// contiguous readable data, empty only when ring is closed and drained
+	auto readable() noexcept -> std::span<const std::byte> {
+		const size_t r = read.load(std::memory_order_relaxed);
+
+		for (;;) {
+			const size_t value = written.load(std::memory_order_acquire);
+			const size_t w = value & ~closed_bit;
+
+			if (w != r) {
+				const size_t offset = r & (capacity - 1u);
+				return std::span<const std::byte>(storage.get() + offset, std::min(w - r, capacity - offset));
+			}
+
+			if ((value & closed_bit) != 0u) {
+				return {};
+			}
+
+			written.wait(value, std::memory_order_acquire);
+		}
+	}
+
+	void release(size_t n) noexcept {
+		read.fetch_add(n, std::memory_order_release);
+		read.notify_one();
+	}
+};
+
+template <typename Outer, typename Inner> struct dual_digest_result {
+	Outer compressed;
+	Inner decompressed;
+	uint64_t compressed_size{0u};
+	uint64_t decompressed_size{0u};
+};
+
+// hashes encoded stream and its decoded content in one pass (for example digest of compressed layer
+// and of the tar inside it): encoded input is hashed and decoded in thread calling `update` and the
+// decoded output goes through bounded ring into second thread which hashes it
+template <typename OuterHasher, typename InnerHasher, stream_decoder Decoder> struct dual_digest {
+	using outer_result_t = decltype(std::declval<OuterHasher &>().final());
+	using inner_result_t = decltype(std::declval<InnerHasher &>().final());
+	using result_t = dual_digest_result<outer_result_t, inner_result_t>;
+
+	static constexpr size_t default_ring_size = 1024u * 1024u;
+
+	OuterHasher outer;
+	InnerHasher inner;
+	Decoder decoder;
+	byte_ring ring;
+
+	uint64_t encoded_length{0u};
+	uint64_t decoded_length{0u};
+	bool failed{false};
+
+	// consumer is last, so it's joined before anything else is destroyed
+	std::jthread consumer;
+
+	explicit dual_digest(OuterHasher o = {}, InnerHasher i = {}, Decoder d = {}, size_t ring_size = default_ring_size): outer{std::move(o)}, inner{std::move(i)}, decoder{std::move(d)}, ring(ring_size), consumer([this] { consume(); }) { }
+
+	dual_digest(const dual_digest &) = delete;
+	dual_digest & operator=(const dual_digest &) = delete;
+
+	~dual_digest() {
+		if (consumer.joinable()) {
+			ring.close();
+		}
+	}
+
+	// returns false when input can't be decoded
+	bool update(std::span<const std::byte> input) {
+		if (failed) {
+			return false;
+		}
+
+		outer.update(input);
+		encoded_length += input.size();
+
+		while (!input.empty()) {
+			const auto out = ring.writable();
+			const decode_step step = decoder.decode(input, out);
+
+			if (step.error || (step.consumed == 0u && step.produced == 0u)) {
+				failed = true;
+				return false;
+			}
+
+			ring.commit(step.produced);
+			decoded_length += step.produced;
+			input = input.subspan(step.consumed);
+		}
+
+		return true;
+	}
+
+	// nullopt when stream was not decoded completely
+	auto final() -> std::optional<result_t> {
+		// flush output buffered in decoder
+		while (!failed && !decoder.finished()) {
+			const auto out = ring.writable();
+			const decode_step step = decoder.decode({}, out);
+
+			ring.commit(step.produced);
+			decoded_length += step.produced;
+
+			if (step.error || step.produced == 0u) {
+				break;
+			}
+		}
+
+		ring.close();
+		consumer.join();
+
+		if (failed || !decoder.finished()) {
+			return std::nullopt;
+		}
+
+		return result_t{outer.final(), inner.final(), encoded_length, decoded_length};
+	}
+
+private:
+	void consume() {
+		for (auto chunk = ring.readable(); !chunk.empty(); chunk = ring.readable()) {
+			inner.update(chunk);
+			ring.release(chunk.size());
+		}
+	}
+};
+
+} // namespace cthash
+
+#endif
@@ -0,0 +1,446 @@
+#ifndef CTHASH_ENCODING_HPP
+#define CTHASH_ENCODING_HPP
+
+#include "parse.hpp"
+#include "value.hpp"
+#include "sha2/sha256.hpp"
+#include "sha2/sha384.hpp"
+#include "sha2/sha512.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#ifdef __SSSE3__
+#include <immintrin.h>
+#endif
+
+namespace cthash {
+
+// encodings of RFC 4648, decoders accept input with or without padding
+
+struct base64_encoding {
+	static constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	static constexpr size_t bits = 6u;
+	static constexpr bool padding = true;
+};
+
+struct base64url_encoding {
+	static constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+	static constexpr size_t bits = 6u;
+	static constexpr bool padding = false;
+};
+
+// decoder accepts also lowercase letters
+struct base32_encoding {
+	static constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+	static constexpr size_t bits = 5u;
+	static constexpr bool padding = true;
+};
+
+namespace internal {
+
+	// input is processed in groups of bytes which are encoded into whole number of characters
+	template <typename Encoding> constexpr size_t group_bytes = (Encoding::bits == 6u) ? 3u : 5u;
+	template <typename Encoding> constexpr size_t group_chars = group_bytes<Encoding> * 8u / Encoding::bits;
+
+	template <typename Encoding> constexpr size_t unpadded_length(size_t bytes) noexcept {
+		return (bytes * 8u + Encoding::bits - 1u) / Encoding::bits;
+	}
+
+	template <typename Encoding> constexpr size_t padded_length(size_t bytes) noexcept {
+		return (bytes + group_bytes<Encoding> - 1u) / group_bytes<Encoding> * group_chars<Encoding>;
+	}
+
+	template <typename Encoding> constexpr auto decoding_table = [] {
+		std::array<int8_t, 256> table{};
+		table.fill(-1);
+
+		for (size_t i = 0; i != Encoding::alphabet.size(); ++i) {
+			const char c = Encoding::alphabet[i];
+			table[static_cast<unsigned char>(c)] = static_cast<int8_t>(i);
+
+			if (Encoding::bits == 5u && c >= 'A' && c <= 'Z') {
+				table[static_cast<unsigned char>(c - 'A' + 'a')] = static_cast<int8_t>(i);
+			}
+		}
+
+		return table;
+	}();
+
+#ifdef __SSSE3__
+	// 12 bytes into 16 characters (reads 16 bytes), splitting of bits and mapping into alphabet as described by Wojciech Muła
+	template <typename Encoding> inline __m128i base64_encode_block(__m128i in) noexcept {
+		in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+		const __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+		const __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+		const __m128i indices = _mm_or_si128(t0, t1);
+
+		// ranges of alphabet: 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12
+		__m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+		range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+
+		constexpr char c62 = Encoding::alphabet[62];
+		constexpr char c63 = Encoding::alphabet[63];
+		const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, static_cast<char>(c62 - 62), static_cast<char>(c63 - 63), 'A', 0, 0);
+
+		return _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range));
+	}
+
+	// 10 bytes into 16 characters (reads 16 bytes), each 16 bit lane gets two bytes containing its 5 bits which
+	// are shifted into place by multiplication
+	inline __m128i base32_encode_block(__m128i in) noexcept {
+		const __m128i first = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 1, 0, 2, 1, 2, 1, 3, 2, 4, 3, 4, 3, -1, 4));
+		const __m128i second = _mm_shuffle_epi8(in, _mm_setr_epi8(6, 5, 6, 5, 7, 6, 7, 6, 8, 7, 9, 8, 9, 8, -1, 9));
+
+		// high half of product is shift right by 11, 6, 9, 4, 7, 10, 5 and 8 bits
+		const __m128i shifts = _mm_setr_epi16(32, 1024, 128, 4096, 512, 64, 2048, 256);
+		const __m128i mask = _mm_set1_epi16(0x1F);
+
+		const __m128i indices = _mm_packus_epi16(_mm_and_si128(_mm_mulhi_epu16(first, shifts), mask), _mm_and_si128(_mm_mulhi_epu16(second, shifts), mask));
+
+		// 0..25 -> 'A'..'Z', 26..31 -> '2'..'7'
+		const __m128i digits = _mm_and_si128(_mm_cmpgt_epi8(indices, _mm_set1_epi8(25)), _mm_set1_epi8('2' - 26 - 'A'));
+		return _mm_add_epi8(_mm_add_epi8(indices, _mm_set1_epi8('A')), digits);
+	}
+
+	// mask of characters in range [first, first + count), ranges are shifted to start at -128 for signed comparison
+	inline __m128i in_range(__m128i v, char first, char count) noexcept {
+		return _mm_cmplt_epi8(_mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(0x80 - first))), _mm_set1_epi8(static_cast<char>(0x80 + count)));
+	}
+
+	struct decoded_values {
+		__m128i values;
+		int valid; // mask of valid characters
+	};
+
+	template <typename Encoding> inline auto decode_values(__m128i v) noexcept -> decoded_values {
+		__m128i valid;
+		__m128i values;
+
+		if constexpr (Encoding::bits == 6u) {
+			const __m128i upper = in_range(v, 'A', 26);
+			const __m128i lower = in_range(v, 'a', 26);
+			const __m128i digit = in_range(v, '0', 10);
+			const __m128i c62 = _mm_cmpeq_epi8(v, _mm_set1_epi8(Encoding::alphabet[62]));
+			const __m128i c63 = _mm_cmpeq_epi8(v, _mm_set1_epi8(Encoding::alphabet[63]));
+
+			valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(c62, c63)));
+			values = _mm_or_si128(_mm_and_si128(upper, _mm_sub_epi8(v, _mm_set1_epi8('A'))), _mm_and_si128(lower, _mm_sub_epi8(v, _mm_set1_epi8('a' - 26))));
+			values = _mm_or_si128(values, _mm_and_si128(digit, _mm_add_epi8(v, _mm_set1_epi8(52 - '0'))));
+			values = _mm_or_si128(values, _mm_or_si128(_mm_and_si128(c62, _mm_set1_epi8(62)), _mm_and_si128(c63, _mm_set1_epi8(63))));
+		} else {
+			const __m128i upper = in_range(v, 'A', 26);
+			const __m128i lower = in_range(v, 'a', 26);
+			const __m128i digit = in_range(v, '2', 6);
+
+			valid = _mm_or_si128(_mm_or_si128(upper, lower), digit);
+			values = _mm_or_si128(_mm_and_si128(upper, _mm_sub_epi8(v, _mm_set1_epi8('A'))), _mm_and_si128(lower, _mm_sub_epi8(v, _mm_set1_epi8('a'))));
+			values = _mm_or_si128(values, _mm_and_si128(digit, _mm_sub_epi8(v, _mm_set1_epi8('2' - 26))));
+		}
+
+		return decoded_values{values, _mm_movemask_epi8(valid)};
+	}
+
+	// 16 characters into 12 bytes, values are joined by multiply-add into 24 bit groups
+	inline void base64_decode_block(__m128i values, std::byte * out) noexcept {
+		const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+		const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+		const __m128i bytes = _mm_shuffle_epi8(groups, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+		const auto tail = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(bytes, 8)));
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(out), bytes);
+		std::memcpy(out + 8, &tail, sizeof(tail));
+	}
+
+	// 16 characters into 10 bytes, values are joined by multiply-add into 20 bit halves of 40 bit groups
+	inline void base32_decode_block(__m128i values, std::byte * out) noexcept {
+		const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi16(0x0120));
+		const __m128i halves = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00010400));
+		const __m128i groups = _mm_or_si128(_mm_slli_epi64(_mm_and_si128(halves, _mm_set1_epi64x(0xFFFF'FFFF)), 20), _mm_srli_epi64(halves, 32));
+		const __m128i bytes = _mm_shuffle_epi8(groups, _mm_setr_epi8(4, 3, 2, 1, 0, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1));
+
+		const auto tail = static_cast<uint16_t>(_mm_extract_epi16(bytes, 4));
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(out), bytes);
+		std::memcpy(out + 8, &tail, sizeof(tail));
+	}
+#endif
+
+	// returns number of written characters
+	template <typename Encoding> constexpr size_t encode_into(std::span<const std::byte> in, char * out) noexcept {
+		constexpr size_t gb = group_bytes<Encoding>;
+		constexpr size_t gc = group_chars<Encoding>;
+		constexpr uint64_t mask = (uint64_t{1} << Encoding::bits) - 1u;
+
+		const char * const begin = out;
+
+#ifdef __SSSE3__
+		if (!std::is_constant_evaluated()) {
+			// whole groups which give 16 characters
+			constexpr size_t block = 16u / gc * gb;
+
+			while (in.size() >= 16u) {
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in.data()));
+
+				if constexpr (Encoding::bits == 6u) {
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(out), base64_encode_block<Encoding>(v));
+				} else {
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(out), base32_encode_block(v));
+				}
+
+				in = in.subspan(block);
+				out += 16;
+			}
+		}
+#endif
+
+		// whole groups
+		for (; in.size() >= gb; in = in.subspan(gb)) {
+			uint64_t group = 0u;
+			for (size_t i = 0; i != gb; ++i) {
+				group = (group << 8u) | std::to_integer<uint64_t>(in[i]);
+			}
+
+			for (size_t i = 0; i != gc; ++i) {
+				*out++ = Encoding::alphabet[(group >> (Encoding::bits * (gc - 1u - i))) & mask];
+			}
+		}
+
+		// last partial group is padded with zero bits
+		if (!in.empty()) {
+			uint64_t group = 0u;
+			for (size_t i = 0; i != gb; ++i) {
+				group = (group << 8u) | (i < in.size() ? std::to_integer<uint64_t>(in[i]) : 0u);
+			}
+
+			const size_t chars = unpadded_length<Encoding>(in.size());
+
+			for (size_t i = 0; i != gc; ++i) {
+				if (i < chars) {
+					*out++ = Encoding::alphabet[(group >> (Encoding::bits * (gc - 1u - i))) & mask];
+				} else if constexpr (Encoding::padding) {
+					*out++ = '=';
+				}
+			}
+		}
+
+		return static_cast<size_t>(out - begin);
+	}
+
+	// input without padding, returns position of first invalid character (or size of input), last character
+	// is invalid when it has non-zero bits after the end of data
+	template <typename Encoding> constexpr size_t decode_into(std::string_view in, std::byte * out) noexcept {
+		constexpr size_t gb = group_bytes<Encoding>;
+		constexpr size_t gc = group_chars<Encoding>;
+
+		size_t pos = 0u;
+
+#ifdef __SSSE3__
+		if (!std::is_constant_evaluated()) {
+			// 16 characters are whole groups (there are no unused bits in them)
+			for (; pos + 16u <= in.size(); pos += 16u) {
+				const auto [values, valid] = decode_values<Encoding>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in.data() + pos)));
+
+				if (valid != 0xFFFF) {
+					return pos + static_cast<size_t>(std::countr_one(static_cast<unsigned>(valid)));
+				}
+
+				if constexpr (Encoding::bits == 6u) {
+					base64_decode_block(values, out);
+				} else {
+					base32_decode_block(values, out);
+				}
+
+				out += 16u / gc * gb;
+			}
+		}
+#endif
+
+		for (; pos < in.size(); pos += gc) {
+			const size_t chars = std::min(gc, in.size() - pos);
+			uint64_t group = 0u;
+
+			for (size_t i = 0; i != gc; ++i) {
+				int8_t v = 0;
+
+				if (i < chars) {
+					v = decoding_table<Encoding>[static_cast<unsigned char>(in[pos + i])];
+					if (v < 0) {
+						return pos + i;
+					}
+				}
+
+				group = (group << Encoding::bits) | static_cast<uint64_t>(v);
+			}
+
+			const size_t bytes = std::min(gb, chars * Encoding::bits / 8u);
+
+			// bits of last character which are not part of any byte must be zero (RFC 4648 section 3.5)
+			if ((group & ((uint64_t{1} << (gc * Encoding::bits - bytes * 8u)) - 1u)) != 0u) {
+				return pos + chars - 1u;
+			}
+
+			for (size_t i = 0; i != bytes; ++i) {
+				*out++ = static_cast<std::byte>(group >> (8u * (gb - 1u - i)));
+			}
+		}
+
+		return in.size();
+	}
+
+} // namespace internal
+
+template <typename Encoding> constexpr size_t encoded_length(size_t bytes) noexcept {
+	return Encoding::padding ? internal::padded_length<Encoding>(bytes) : internal::unpadded_length<Encoding>(bytes);
+}
+
+// encoded digest without allocation, returns written part (empty if output is too short)
+template <typename Encoding, size_t N> constexpr auto encode_into(const hash_value<N> & value, std::span<char> out) noexcept -> std::span<char> {
+	if (out.size() < encoded_length<Encoding>(N)) {
+		return {};
+	}
+
+	return out.first(internal::encode_into<Encoding>(std::span<const std::byte>(value), out.data()));
+}
+
+template <typename Encoding, size_t N> constexpr auto encode(const hash_value<N> & value) -> std::string {
+	std::string output(encoded_length<Encoding>(N), '\0');
+	internal::encode_into<Encoding>(std::span<const std::byte>(value), output.data());
+	return output;
+}
+
+template <size_t N> constexpr auto to_base64(const hash_value<N> & value) -> std::string {
+	return encode<base64_encoding>(value);
+}
+
+template <size_t N> constexpr auto to_base64url(const hash_value<N> & value) -> std::string {
+	return encode<base64url_encoding>(value);
+}
+
+template <size_t N> constexpr auto to_base32(const hash_value<N> & value) -> std::string {
+	return encode<base32_encoding>(value);
+}
+
+template <typename Encoding, typename Config> constexpr auto parse_encoded(std::string_view in) noexcept -> parse_result<tagged_hash_value<Config>> {
+	using value_t = tagged_hash_value<Config>;
+	constexpr size_t length = internal::unpadded_length<Encoding>(value_t::digest_length);
+
+	// padding is optional, but if present it must be complete
+	if (in.size() == internal::padded_length<Encoding>(value_t::digest_length) && in.size() != length) {
+		for (size_t i = length; i != in.size(); ++i) {
+			if (in[i] != '=') {
+				return parse_error{parse_error_reason::invalid_character, i};
+			}
+		}
+
+		in = in.substr(0u, length);
+	}
+
+	if (in.size() != length) {
+		return parse_error{parse_error_reason::invalid_length, 0u};
+	}
+
+	value_t output{};
+
+	if (const size_t pos = internal::decode_into<Encoding>(in, output.data()); pos != in.size()) {
+		return parse_error{parse_error_reason::invalid_character, pos};
+	}
+
+	return output;
+}
+
+template <typename Config> constexpr auto parse_base64(std::string_view in) noexcept {
+	return parse_encoded<base64_encoding, Config>(in);
+}
+
+template <typename Config> constexpr auto parse_base64url(std::string_view in) noexcept {
+	return parse_encoded<base64url_encoding, Config>(in);
+}
+
+template <typename Config> constexpr auto parse_base32(std::string_view in) noexcept {
+	return parse_encoded<base32_encoding, Config>(in);
+}
+
+// subresource integrity (https://www.w3.org/TR/SRI/) supports only these algorithms
+template <typename Config> struct sri_algorithm;
+
+template <> struct sri_algorithm<sha256_config> {
+	static constexpr std::string_view name = "sha256";
+};
+
+template <> struct sri_algorithm<sha384_config> {
+	static constexpr std::string_view name = "sha384";
+};
+
+template <> struct sri_algorithm<sha512_config> {
+	static constexpr std::string_view name = "sha512";
+};
+
+template <typename Config> constexpr auto sri(const tagged_hash_value<Config> & value) -> std::string {
+	constexpr std::string_view name = sri_algorithm<Config>::name;
+	constexpr size_t length = encoded_length<base64_encoding>(tagged_hash_value<Config>::digest_length);
+
+	std::string output(name.size() + 1u + length, '-');
+	std::copy(name.begin(), name.end(), output.begin());
+	internal::encode_into<base64_encoding>(std::span<const std::byte>(value), output.data() + name.size() + 1u);
+	return output;
+}
+
+namespace literals {
+
+	// invalid input is compile-time error
+	template <internal::fixed_string Value>
+	consteval auto operator""_sha256_b64() {
+		return parse_base64<sha256_config>(Value).value();
+	}
+
+	template <internal::fixed_string Value>
+	consteval auto operator""_sha384_b64() {
+		return parse_base64<sha384_config>(Value).value();
+	}
+
+	template <internal::fixed_string Value>
+	consteval auto operator""_sha512_b64() {
+		return parse_base64<sha512_config>(Value).value();
+	}
+
+	template <internal::fixed_string Value>
+	consteval auto operator""_sha256_b64url() {
+		return parse_base64url<sha256_config>(Value).value();
+	}
+
+	template <internal::fixed_string Value>
+	consteval auto operator""_sha384_b64url() {
+		return parse_base64url<sha384_config>(Value).value();
+	}
+
+	template <internal::fixed_string Value>
+	consteval auto operator""_sha512_b64url() {
+		return parse_base64url<sha512_config>(Value).value();
+	}
+
+	template <internal::fixed_string Value>
+	consteval auto operator""_sha256_b32() {
+		return parse_base32<sha256_config>(Value).value();
+	}
+
+	template <internal::fixed_string Value>
+	consteval auto operator""_sha384_b32() {
+		return parse_base32<sha384_config>(Value).value();
+	}
+
+	template <internal::fixed_string Value>
+	consteval auto operator""_sha512_b32() {
+		return parse_base32<sha512_config>(Value).value();
+	}
+
+} // namespace literals
+
+} // namespace cthash
+
+#endif
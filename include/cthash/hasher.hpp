@@ -216,6 +216,107 @@ template <typename Config> struct internal_hasher {
 		rounds(w, hash);
 	}
 
+	// multi-buffer support (independent messages are processed in lanes, one 256 bit register wide)
+	static constexpr size_t lanes = 32u / sizeof(state_item_t);
+
+	using lane_state_t = state_value_t;
+	using final_blocks_t = std::array<std::byte, block_size_bytes * 2u>;
+
+	template <size_t Lanes> using lanes_staging_value_t = std::array<std::array<staging_item_t, Lanes>, staging_size>;
+	template <size_t Lanes> using lanes_state_value_t = std::array<std::array<state_item_t, Lanes>, std::tuple_size_v<state_value_t>>;
+
+	static constexpr auto initial_lane_state() noexcept -> lane_state_t {
+		return config.initial_values;
+	}
+
+	// number of blocks needed to process message of `length` bytes including padding
+	static constexpr size_t padded_blocks_count(size_t length) noexcept {
+		return (length + 1u + (config.length_size_bits / 8u) + (block_size_bytes - 1u)) / block_size_bytes;
+	}
+
+	// prepare padded last one or two blocks from unprocessed remainder of message
+	static constexpr size_t build_final_blocks(std::span<const std::byte> tail, length_t total_length, final_blocks_t & out) noexcept {
+		CTHASH_ASSERT(tail.size() < block_size_bytes);
+
+		block_value_t first;
+		std::copy(tail.begin(), tail.end(), first.begin());
+
+		if (finalize_buffer(first, tail.size())) {
+			block_value_t second;
+			std::fill(second.begin(), second.end(), std::byte{0x0u});
+			finalize_buffer_by_writing_length(second, total_length);
+
+			std::copy(first.begin(), first.end(), out.begin());
+			std::copy(second.begin(), second.end(), out.begin() + block_size_bytes);
+			return 2u;
+		}
+
+		finalize_buffer_by_writing_length(first, total_length);
+		std::copy(first.begin(), first.end(), out.begin());
+		return 1u;
+	}
+
+	template <size_t Lanes> [[gnu::always_inline]] static constexpr auto build_staging_lanes(const std::array<const std::byte *, Lanes> & chunks) noexcept -> lanes_staging_value_t<Lanes> {
+		lanes_staging_value_t<Lanes> w;
+
+		constexpr auto first_part_size = block_size_bytes / sizeof(staging_item_t);
+
+		for (int i = 0; i != int(first_part_size); ++i) {
+			for (size_t l = 0; l != Lanes; ++l) {
+				w[i][l] = cast_from_bytes<staging_item_t>(std::span<const std::byte, sizeof(staging_item_t)>(chunks[l] + i * sizeof(staging_item_t), sizeof(staging_item_t)));
+			}
+		}
+
+		// loops are ordered so lanes are the inner (vectorizable) dimension
+		for (int i = int(first_part_size); i != int(staging_size); ++i) {
+			for (size_t l = 0; l != Lanes; ++l) {
+				w[i][l] = w[i - 16][l] + config.sigma_0(w[i - 15][l]) + w[i - 7][l] + config.sigma_1(w[i - 2][l]);
+			}
+		}
+
+		return w;
+	}
+
+	// process `count` consecutive blocks of each lane (every lane has its own state and input)
+	template <size_t Lanes> static constexpr void compress_lanes(const std::array<lane_state_t *, Lanes> & states, std::array<const std::byte *, Lanes> blocks, size_t count) noexcept {
+		lanes_state_value_t<Lanes> transposed;
+
+		for (size_t i = 0; i != transposed.size(); ++i) {
+			for (size_t l = 0; l != Lanes; ++l) {
+				transposed[i][l] = (*states[l])[i];
+			}
+		}
+
+		for (; count != 0u; --count) {
+			const auto w = build_staging_lanes<Lanes>(blocks);
+			config.template rounds_lanes<Lanes>(w, transposed);
+
+			for (auto & ptr: blocks) {
+				ptr += block_size_bytes;
+			}
+		}
+
+		for (size_t i = 0; i != transposed.size(); ++i) {
+			for (size_t l = 0; l != Lanes; ++l) {
+				(*states[l])[i] = transposed[i][l];
+			}
+		}
+	}
+
+	static constexpr void compress(lane_state_t & state, const std::byte * blocks, size_t count) noexcept {
+		for (; count != 0u; --count) {
+			const staging_value_t w = build_staging(block_view_t(blocks, block_size_bytes));
+			rounds(w, state);
+			blocks += block_size_bytes;
+		}
+	}
+
+	static constexpr void write_lane_result_into(const lane_state_t & state, digest_span_t out) noexcept {
+		internal_hasher tmp;
+		tmp.hash = state;
+		tmp.write_result_into(out);
+	}
+
 	[[gnu::always_inline]] constexpr void write_result_into(digest_span_t out) noexcept
 	requires(digest_bytes % sizeof(state_item_t) == 0u)
 	{
@@ -1,7 +1,11 @@
 #ifndef CTHASH_INTERNAL_ALGORITHM_HPP
 #define CTHASH_INTERNAL_ALGORITHM_HPP
 
+#include "bit.hpp"
+#include <bit>
+#include <cstring>
 #include <numeric>
+#include <type_traits>
 #include <compare>
 #include <cstddef>
 #include <cstdint>
@@ -18,6 +22,109 @@ template <typename It1, typename It2> constexpr auto threeway_compare_of_same_si
 	return std::strong_ordering::equal;
 }
 
+// word-wide comparisons of byte arrays with length known at compile time (compiler unrolls them)
+
+[[gnu::always_inline]] inline uint64_t load_word(const std::byte * ptr) noexcept {
+	uint64_t w;
+	std::memcpy(&w, ptr, sizeof(w));
+	return w;
+}
+
+// first (up to) 8 bytes as native word, digests are uniformly distributed so it's good enough hash
+template <size_t N> constexpr uint64_t prefix_word(const std::byte * ptr) noexcept {
+	constexpr size_t length = (N < sizeof(uint64_t)) ? N : sizeof(uint64_t);
+
+	if (std::is_constant_evaluated() || length != sizeof(uint64_t)) {
+		uint64_t w = 0u;
+		for (size_t i = 0; i != length; ++i) {
+			w |= std::to_integer<uint64_t>(ptr[i]) << (8u * i);
+		}
+		return w;
+	}
+
+	return load_word(ptr);
+}
+
+template <size_t N> constexpr bool equal_bytes(const std::byte * lhs, const std::byte * rhs) noexcept {
+	if (std::is_constant_evaluated()) {
+		for (size_t i = 0; i != N; ++i) {
+			if (lhs[i] != rhs[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	uint64_t diff = 0u;
+	size_t i = 0;
+
+	for (; i + 8u <= N; i += 8u) {
+		diff |= load_word(lhs + i) ^ load_word(rhs + i);
+	}
+
+	for (; i != N; ++i) {
+		diff |= std::to_integer<uint64_t>(lhs[i] ^ rhs[i]);
+	}
+
+	return diff == 0u;
+}
+
+// lexicographic order of bytes is order of big-endian words
+template <size_t N> constexpr auto compare_bytes(const std::byte * lhs, const std::byte * rhs) noexcept -> std::strong_ordering {
+	if (std::is_constant_evaluated()) {
+		return threeway_compare_of_same_size(lhs, rhs, N);
+	}
+
+	size_t i = 0;
+
+	for (; i + 8u <= N; i += 8u) {
+		const uint64_t a = load_word(lhs + i);
+		const uint64_t b = load_word(rhs + i);
+
+		if (a != b) {
+			if constexpr (std::endian::native == std::endian::little) {
+				return byteswap(a) <=> byteswap(b);
+			} else {
+				return a <=> b;
+			}
+		}
+	}
+
+	return threeway_compare_of_same_size(lhs + i, rhs + i, N - i);
+}
+
+// all bytes are always read and there is no data-dependent branch
+template <size_t N> constexpr bool constant_time_equal_bytes(const std::byte * lhs, const std::byte * rhs) noexcept {
+	uint64_t diff = 0u;
+
+	if (std::is_constant_evaluated()) {
+		for (size_t i = 0; i != N; ++i) {
+			diff |= std::to_integer<uint64_t>(lhs[i] ^ rhs[i]);
+		}
+		return diff == 0u;
+	}
+
+	size_t i = 0;
+
+	for (; i + 8u <= N; i += 8u) {
+		diff |= load_word(lhs + i) ^ load_word(rhs + i);
+#if defined(__GNUC__)
+		// optimizer doesn't know the value anymore, so it can't stop early
+		__asm__("" : "+r"(diff));
+#endif
+	}
+
+	for (; i != N; ++i) {
+		diff |= std::to_integer<uint64_t>(lhs[i] ^ rhs[i]);
+#if defined(__GNUC__)
+		__asm__("" : "+r"(diff));
+#endif
+	}
+
+	// top bit of (diff | -diff) is set for any non-zero diff
+	return (((diff | (0u - diff)) >> 63u) ^ 1u) != 0u;
+}
+
 template <typename T, typename It1, typename It2, typename Stream> constexpr auto & push_to_stream_as(It1 f, It2 l, Stream & stream) {
 	constexpr auto cast_and_shift = [](Stream * s, const auto & rhs) { (*s) << T{rhs}; return s; };
 	return *std::accumulate(f, l, &stream, cast_and_shift);
@@ -2,6 +2,8 @@
 #define CTHASH_INTERNAL_BIT_HPP
 
 #include <bit>
+#include <concepts>
+#include <cstddef>
 
 namespace cthash::internal {
 
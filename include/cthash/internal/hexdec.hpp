@@ -2,9 +2,15 @@
 #define CTHASH_INTERNAL_HEXDEC_HPP
 
 #include <array>
+#include <bit>
+#include <cstring>
 #include <ostream>
 #include <span>
 #include <type_traits>
+#include <cstdint>
+#if defined(__SSSE3__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 namespace cthash::internal {
 
@@ -34,6 +40,168 @@ constexpr auto hexdec_to_value_alphabet = get_hexdec_table();
 
 template <typename CharT> constexpr auto value_to_hexdec_alphabet = std::array<CharT, 16>{CharT('0'), CharT('1'), CharT('2'), CharT('3'), CharT('4'), CharT('5'), CharT('6'), CharT('7'), CharT('8'), CharT('9'), CharT('a'), CharT('b'), CharT('c'), CharT('d'), CharT('e'), CharT('f')};
 
+template <typename CharT> constexpr auto value_to_upper_hexdec_alphabet = std::array<CharT, 16>{CharT('0'), CharT('1'), CharT('2'), CharT('3'), CharT('4'), CharT('5'), CharT('6'), CharT('7'), CharT('8'), CharT('9'), CharT('A'), CharT('B'), CharT('C'), CharT('D'), CharT('E'), CharT('F')};
+
+// writes 2 characters for each byte
+template <typename CharT> constexpr void encode_hexdec(std::span<const std::byte> in, CharT * out, bool upper = false) noexcept {
+	if (!std::is_constant_evaluated()) {
+		if constexpr (sizeof(CharT) == 1u) {
+#ifdef __AVX2__
+			// same as SSSE3 below with 32 bytes at once, shuffle and unpack work within 128 bit lanes, so
+			// halves of output are put back in order by permutation
+			const __m256i wide_alphabet = upper ? _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F') : _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+			const __m256i wide_low_mask = _mm256_set1_epi8(0x0F);
+
+			while (in.size() >= 32u) {
+				const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in.data()));
+				const __m256i hi = _mm256_shuffle_epi8(wide_alphabet, _mm256_and_si256(_mm256_srli_epi16(v, 4), wide_low_mask));
+				const __m256i lo = _mm256_shuffle_epi8(wide_alphabet, _mm256_and_si256(v, wide_low_mask));
+
+				const __m256i first = _mm256_unpacklo_epi8(hi, lo);
+				const __m256i second = _mm256_unpackhi_epi8(hi, lo);
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_permute2x128_si256(first, second, 0x20));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 32), _mm256_permute2x128_si256(first, second, 0x31));
+
+				in = in.subspan(32u);
+				out += 64;
+			}
+#endif
+#ifdef __SSSE3__
+			// nibbles are used as indices into alphabet by one shuffle, 16 bytes at once
+			const __m128i alphabet = upper ? _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F') : _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+			const __m128i low_mask = _mm_set1_epi8(0x0F);
+
+			while (in.size() >= 16u) {
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in.data()));
+				const __m128i hi = _mm_shuffle_epi8(alphabet, _mm_and_si128(_mm_srli_epi16(v, 4), low_mask));
+				const __m128i lo = _mm_shuffle_epi8(alphabet, _mm_and_si128(v, low_mask));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi8(hi, lo));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16), _mm_unpackhi_epi8(hi, lo));
+
+				in = in.subspan(16u);
+				out += 32;
+			}
+#endif
+			if constexpr (std::endian::native == std::endian::little) {
+				// 4 bytes are spread into 8 nibbles (one per byte of word) and converted together
+				const uint64_t letter_offset = upper ? 7u : 39u;
+
+				while (in.size() >= 4u) {
+					uint64_t v = 0u;
+					for (size_t i = 0; i != 4u; ++i) {
+						v |= uint64_t{std::to_integer<uint8_t>(in[i])} << (16u * i);
+					}
+
+					const uint64_t nibbles = ((v >> 4u) & 0x000F'000F'000F'000Full) | ((v & 0x000F'000F'000F'000Full) << 8u);
+					const uint64_t letters = ((nibbles + 0x0606'0606'0606'0606ull) >> 4u) & 0x0101'0101'0101'0101ull;
+					const uint64_t chars = nibbles + 0x3030'3030'3030'3030ull + letters * letter_offset;
+
+					std::memcpy(out, &chars, sizeof(chars));
+
+					in = in.subspan(4u);
+					out += 8;
+				}
+			}
+		}
+	}
+
+	const auto & alphabet = upper ? value_to_upper_hexdec_alphabet<CharT> : value_to_hexdec_alphabet<CharT>;
+
+	for (std::byte b: in) {
+		*out++ = alphabet[unsigned(b >> 4u)];
+		*out++ = alphabet[unsigned(b) & 0b1111u];
+	}
+}
+
+// value of hexadecimal digit or -1 if it's not a digit
+template <typename CharT> constexpr int hexdec_digit_value(CharT c) noexcept {
+	if (c >= CharT('0') && c <= CharT('9')) {
+		return static_cast<int>(c - CharT('0'));
+	} else if (c >= CharT('a') && c <= CharT('f')) {
+		return static_cast<int>(c - CharT('a')) + 10;
+	} else if (c >= CharT('A') && c <= CharT('F')) {
+		return static_cast<int>(c - CharT('A')) + 10;
+	} else {
+		return -1;
+	}
+}
+
+// reads 2 characters for each byte of output, returns position of first invalid character (or size of input),
+// unpaired last character of odd-length input is invalid
+template <typename CharT> constexpr size_t decode_hexdec(std::span<const CharT> in, std::byte * out) noexcept {
+	const size_t size = in.size() & ~size_t{1};
+	size_t pos = 0u;
+
+	if (!std::is_constant_evaluated()) {
+		if constexpr (sizeof(CharT) == 1u) {
+#ifdef __SSSE3__
+			// 16 characters at once: validation by range comparisons, pairs of nibbles joined by multiply-add
+			for (; pos + 16u <= size; pos += 16u) {
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in.data() + pos));
+				const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+
+				// shifted so ranges start at -128 and signed comparison can be used
+				const __m128i digit = _mm_cmplt_epi8(_mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(0x80 - '0'))), _mm_set1_epi8(static_cast<char>(0x80 + 10)));
+				const __m128i alpha = _mm_cmplt_epi8(_mm_add_epi8(lower, _mm_set1_epi8(static_cast<char>(0x80 - 'a'))), _mm_set1_epi8(static_cast<char>(0x80 + 6)));
+
+				if (const int valid = _mm_movemask_epi8(_mm_or_si128(digit, alpha)); valid != 0xFFFF) {
+					return pos + static_cast<size_t>(std::countr_one(static_cast<unsigned>(valid)));
+				}
+
+				const __m128i nibbles = _mm_or_si128(_mm_and_si128(digit, _mm_sub_epi8(v, _mm_set1_epi8('0'))), _mm_and_si128(alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+				const __m128i bytes = _mm_maddubs_epi16(nibbles, _mm_set1_epi16(0x0110));
+
+				_mm_storel_epi64(reinterpret_cast<__m128i *>(out + pos / 2u), _mm_packus_epi16(bytes, bytes));
+			}
+#endif
+			if constexpr (std::endian::native == std::endian::little) {
+				// 8 characters in one word (only ASCII range, so additions don't overflow to next byte)
+				constexpr uint64_t ones = 0x0101'0101'0101'0101ull;
+
+				for (; pos + 8u <= size; pos += 8u) {
+					uint64_t w;
+					std::memcpy(&w, in.data() + pos, sizeof(w));
+
+					const uint64_t lower = w | (ones * 0x20u);
+					const uint64_t digit = (w + ones * (0x80u - '0')) & ~(w + ones * (0x80u - '9' - 1u));
+					const uint64_t alpha = (lower + ones * (0x80u - 'a')) & ~(lower + ones * (0x80u - 'f' - 1u));
+
+					if ((w & (ones * 0x80u)) != 0u || ((digit | alpha) & (ones * 0x80u)) != ones * 0x80u) {
+						// exact position is found by scalar code
+						break;
+					}
+
+					const uint64_t nibbles = (w & (ones * 0x0Fu)) + ((alpha >> 7u) & ones) * 9u;
+
+					uint64_t bytes = ((nibbles & 0x0F00'0F00'0F00'0F00ull) >> 8u) | ((nibbles & 0x000F'000F'000F'000Full) << 4u);
+					bytes = (bytes | (bytes >> 8u)) & 0x0000'FFFF'0000'FFFFull;
+					bytes = (bytes | (bytes >> 16u)) & 0x0000'0000'FFFF'FFFFull;
+
+					const auto word = static_cast<uint32_t>(bytes);
+					std::memcpy(out + pos / 2u, &word, sizeof(word));
+				}
+			}
+		}
+	}
+
+	for (; pos != size; pos += 2u) {
+		const int hi = hexdec_digit_value(in[pos]);
+		const int lo = hexdec_digit_value(in[pos + 1u]);
+
+		if (hi < 0) {
+			return pos;
+		} else if (lo < 0) {
+			return pos + 1u;
+		}
+
+		out[pos / 2u] = static_cast<std::byte>((hi << 4) | lo);
+	}
+
+	return size;
+}
+
 struct byte_hexdec_value {
 	std::byte val;
 
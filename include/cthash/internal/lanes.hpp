@@ -0,0 +1,238 @@
+#ifndef CTHASH_INTERNAL_LANES_HPP
+#define CTHASH_INTERNAL_LANES_HPP
+
+#include "assert.hpp"
+#include <algorithm>
+#include <array>
+#include <span>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+namespace cthash::internal {
+
+// Kernel is internal_hasher<Config> or basic_keccak_hasher<Config>, which provide multi-buffer interface:
+//  lane_state_t, final_blocks_t, block_size_bytes, initial_lane_state(), padded_blocks_count(length),
+//  build_final_blocks(tail, length, out), compress(state, blocks, count), compress_lanes<Lanes>(states, blocks, count)
+
+template <typename Kernel> concept multi_buffer_kernel = requires(typename Kernel::lane_state_t & state, const std::byte * ptr, size_t count) {
+	{ Kernel::block_size_bytes } -> std::convertible_to<size_t>;
+	{ Kernel::lanes } -> std::convertible_to<size_t>;
+	{ Kernel::initial_lane_state() } -> std::same_as<typename Kernel::lane_state_t>;
+	{ Kernel::padded_blocks_count(count) } -> std::same_as<size_t>;
+	Kernel::compress(state, ptr, count);
+};
+
+// one message in flight inside a lane
+template <typename Kernel> struct lane_message {
+	using state_t = typename Kernel::lane_state_t;
+	using final_blocks_t = typename Kernel::final_blocks_t;
+
+	static constexpr size_t block_size = Kernel::block_size_bytes;
+
+	state_t state;
+	const std::byte * body{nullptr}; // full blocks still in the message itself
+	size_t body_blocks{0u};
+	size_t final_blocks{0u}; // padded blocks in `tail`
+	size_t position{0u};	 // in blocks from start of current segment
+	size_t id{0u};
+	bool in_tail{false};
+	final_blocks_t tail;
+
+	constexpr void start(size_t identifier, std::span<const std::byte> in) noexcept {
+		return start(identifier, in, Kernel::initial_lane_state(), 0u);
+	}
+
+	// continue from already calculated state after `prefix` bytes (must be multiple of block size)
+	constexpr void start(size_t identifier, std::span<const std::byte> in, const state_t & initial, size_t prefix) noexcept {
+		CTHASH_ASSERT(prefix % block_size == 0u);
+
+		const size_t full_blocks = in.size() / block_size;
+		const auto remainder = in.subspan(full_blocks * block_size);
+
+		id = identifier;
+		state = initial;
+		body = in.data();
+		body_blocks = full_blocks;
+		final_blocks = Kernel::build_final_blocks(remainder, prefix + in.size(), tail);
+		position = 0u;
+		in_tail = (body_blocks == 0u);
+	}
+
+	// only compress `count` full blocks without any padding
+	constexpr void start_blocks(size_t identifier, const state_t & initial, const std::byte * blocks, size_t count) noexcept {
+		CTHASH_ASSERT(count != 0u);
+
+		id = identifier;
+		state = initial;
+		body = blocks;
+		body_blocks = count;
+		final_blocks = 0u;
+		position = 0u;
+		in_tail = false;
+	}
+
+	constexpr const std::byte * current() const noexcept {
+		return (in_tail ? tail.data() : body) + position * block_size;
+	}
+
+	constexpr size_t remaining_in_segment() const noexcept {
+		return (in_tail ? final_blocks : body_blocks) - position;
+	}
+
+	constexpr size_t remaining() const noexcept {
+		return in_tail ? (final_blocks - position) : (body_blocks - position + final_blocks);
+	}
+
+	// returns true when whole message was processed
+	constexpr bool advance(size_t count) noexcept {
+		CTHASH_ASSERT(count <= remaining_in_segment());
+		position += count;
+
+		if (remaining_in_segment() != 0u) {
+			return false;
+		}
+
+		if (in_tail || final_blocks == 0u) {
+			return true;
+		}
+
+		in_tail = true;
+		position = 0u;
+		return false;
+	}
+
+	// finish the message without other lanes
+	constexpr void finish_scalar() noexcept {
+		while (remaining() != 0u) {
+			const size_t count = remaining_in_segment();
+			Kernel::compress(state, current(), count);
+			advance(count);
+		}
+	}
+};
+
+// runs up to `Lanes` messages at once, lanes which finished are refilled by the caller
+template <typename Kernel, size_t Lanes = Kernel::lanes> struct lanes_engine {
+	using message_t = lane_message<Kernel>;
+	using state_t = typename Kernel::lane_state_t;
+
+	static constexpr size_t lanes = Lanes;
+
+	// when only this many lanes have work and nothing more is coming, finishing them one by one is cheaper
+	static constexpr size_t scalar_threshold = std::max<size_t>(Lanes / 4u, 1u);
+
+	std::array<message_t, Lanes> slots{};
+	std::array<bool, Lanes> busy{};
+	state_t scratch{}; // output of idle lanes
+
+	constexpr size_t active() const noexcept {
+		return static_cast<size_t>(std::count(busy.begin(), busy.end(), true));
+	}
+
+	constexpr bool full() const noexcept {
+		return active() == Lanes;
+	}
+
+	constexpr bool empty() const noexcept {
+		return active() == 0u;
+	}
+
+	constexpr auto free_lane() noexcept -> message_t * {
+		for (size_t l = 0; l != Lanes; ++l) {
+			if (!busy[l]) {
+				busy[l] = true;
+				return &slots[l];
+			}
+		}
+		return nullptr;
+	}
+
+	// returns index of lane used
+	constexpr size_t start(size_t id, std::span<const std::byte> in) noexcept {
+		message_t * lane = free_lane();
+		CTHASH_ASSERT(lane != nullptr);
+		lane->start(id, in);
+		return static_cast<size_t>(lane - slots.data());
+	}
+
+	// continue message from already calculated state after `prefix` bytes
+	constexpr size_t start(size_t id, std::span<const std::byte> in, const state_t & initial, size_t prefix) noexcept {
+		message_t * lane = free_lane();
+		CTHASH_ASSERT(lane != nullptr);
+		lane->start(id, in, initial, prefix);
+		return static_cast<size_t>(lane - slots.data());
+	}
+
+	constexpr size_t start_blocks(size_t id, const state_t & initial, const std::byte * blocks, size_t count) noexcept {
+		message_t * lane = free_lane();
+		CTHASH_ASSERT(lane != nullptr);
+		lane->start_blocks(id, initial, blocks, count);
+		return static_cast<size_t>(lane - slots.data());
+	}
+
+	// process blocks until at least one lane finishes, callback receives finished message
+	template <typename Fn> constexpr void step(Fn && on_finish) noexcept {
+		CTHASH_ASSERT(!empty());
+
+		// single lane is plain scalar compression of whole message
+		if constexpr (Lanes == 1u) {
+			slots[0].finish_scalar();
+			busy[0] = false;
+			on_finish(slots[0]);
+		} else {
+			for (bool finished = false; !finished;) {
+				size_t count = SIZE_MAX;
+				size_t first_busy = Lanes;
+
+				for (size_t l = 0; l != Lanes; ++l) {
+					if (busy[l]) {
+						count = std::min(count, slots[l].remaining_in_segment());
+						first_busy = std::min(first_busy, l);
+					}
+				}
+
+				// idle lanes are computing garbage into scratch state from input of a busy lane
+				std::array<state_t *, Lanes> states;
+				std::array<const std::byte *, Lanes> blocks;
+
+				for (size_t l = 0; l != Lanes; ++l) {
+					states[l] = busy[l] ? &slots[l].state : &scratch;
+					blocks[l] = busy[l] ? slots[l].current() : slots[first_busy].current();
+				}
+
+				Kernel::template compress_lanes<Lanes>(states, blocks, count);
+
+				for (size_t l = 0; l != Lanes; ++l) {
+					if (busy[l] && slots[l].advance(count)) {
+						busy[l] = false;
+						finished = true;
+						on_finish(slots[l]);
+					}
+				}
+			}
+		}
+	}
+
+	// finish everything still in lanes
+	template <typename Fn> constexpr void drain(Fn && on_finish) noexcept {
+		while (!empty()) {
+			if (active() <= scalar_threshold) {
+				for (size_t l = 0; l != Lanes; ++l) {
+					if (busy[l]) {
+						slots[l].finish_scalar();
+						busy[l] = false;
+						on_finish(slots[l]);
+					}
+				}
+				return;
+			}
+
+			step(on_finish);
+		}
+	}
+};
+
+} // namespace cthash::internal
+
+#endif
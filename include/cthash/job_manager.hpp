@@ -0,0 +1,101 @@
+#ifndef CTHASH_JOB_MANAGER_HPP
+#define CTHASH_JOB_MANAGER_HPP
+
+#include "batch.hpp"
+#include "internal/assert.hpp"
+#include "internal/lanes.hpp"
+#include <algorithm>
+#include <array>
+#include <span>
+#include <cstddef>
+
+namespace cthash {
+
+template <typename Result> struct hash_job {
+	std::span<const std::byte> input{};
+	Result digest{};
+	void * user_data{nullptr};
+};
+
+// accepts jobs one by one and processes them in parallel lanes as soon as all lanes have work
+// (jobs are not copied, they need to live until they are returned back by submit or flush)
+template <internal::batchable_hasher Hasher, typename Result = typename Hasher::result_t> struct job_manager {
+	using kernel = internal::kernel_of<Hasher>;
+	using engine_t = internal::lanes_engine<kernel>;
+	using job_t = hash_job<Result>;
+
+	static constexpr size_t lanes = engine_t::lanes;
+
+	engine_t engine{};
+	std::array<job_t *, lanes> in_flight{};
+
+	// finished jobs not yet returned to user
+	std::array<job_t *, lanes> completed{};
+	size_t completed_count{0u};
+
+	constexpr job_manager() noexcept = default;
+	constexpr job_manager(const job_manager &) = delete;
+	constexpr job_manager & operator=(const job_manager &) = delete;
+
+	constexpr size_t size() const noexcept {
+		return engine.active() + completed_count;
+	}
+
+	constexpr bool empty() const noexcept {
+		return size() == 0u;
+	}
+
+	// returns finished job (not necessary the submitted one) or nullptr if there is no finished job yet
+	[[nodiscard]] constexpr job_t * submit(job_t & job) noexcept {
+		if (engine.full()) {
+			// previous submit returned already finished job without running the lanes
+			run();
+		}
+
+		const size_t lane = engine.start(0u, job.input);
+		in_flight[lane] = &job;
+
+		if (engine.full() && completed_count == 0u) {
+			run();
+		}
+
+		return pop();
+	}
+
+	// returns finished job even if not all lanes have work, nullptr when there is no job in manager
+	[[nodiscard]] constexpr job_t * flush() noexcept {
+		if (completed_count == 0u && !engine.empty()) {
+			run();
+		}
+
+		return pop();
+	}
+
+private:
+	constexpr void run() noexcept {
+		engine.step([&](const typename engine_t::message_t & msg) {
+			const auto lane = static_cast<size_t>(&msg - engine.slots.data());
+			job_t * job = in_flight[lane];
+			kernel::write_lane_result_into(msg.state, job->digest);
+
+			CTHASH_ASSERT(completed_count < completed.size());
+			completed[completed_count++] = job;
+		});
+	}
+
+	constexpr job_t * pop() noexcept {
+		if (completed_count == 0u) {
+			return nullptr;
+		}
+
+		// oldest first
+		job_t * job = completed[0];
+		std::copy(completed.begin() + 1, completed.begin() + completed_count, completed.begin());
+		--completed_count;
+		return job;
+	}
+};
+
+} // namespace cthash
+
+#endif
@@ -0,0 +1,272 @@
+#ifndef CTHASH_MERKLE_HPP
+#define CTHASH_MERKLE_HPP
+
+#include "hasher.hpp"
+#include "internal/assert.hpp"
+#include <array>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+namespace cthash {
+
+namespace internal {
+
+	// word-wide check (compiler vectorizes the inner loop)
+	constexpr bool is_all_zero(std::span<const std::byte> in) noexcept {
+		if (std::is_constant_evaluated()) {
+			for (std::byte b: in) {
+				if (b != std::byte{0}) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		constexpr size_t stride = 32u * sizeof(uint64_t);
+
+		while (in.size() >= stride) {
+			std::array<uint64_t, 32> words;
+			std::memcpy(words.data(), in.data(), stride);
+
+			uint64_t acc = 0u;
+			for (uint64_t w: words) {
+				acc |= w;
+			}
+
+			if (acc != 0u) {
+				return false;
+			}
+
+			in = in.subspan(stride);
+		}
+
+		for (std::byte b: in) {
+			if (b != std::byte{0}) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+} // namespace internal
+
+template <typename Hasher> struct merkle_zero_subtrees;
+
+// binary merkle tree over fixed size leaves as in RFC 6962: leaf is H(0x00 || data), node is H(0x01 || left || right)
+// and the last (partial) leaf is hashed as it is, all-zero leaves and subtrees are not hashed again, their
+// digests are computed once (per leaf size) and runs of them are added in O(log n) steps
+template <typename Hasher> struct merkle_hasher {
+	using result_t = decltype(std::declval<Hasher &>().final());
+
+	static_assert(result_t::digest_length != 0u, "only hashers with fixed digest length are supported");
+
+	static constexpr size_t max_levels = 64u;
+	static constexpr std::byte leaf_prefix[1] = {std::byte{0x00}};
+	static constexpr std::byte node_prefix[1] = {std::byte{0x01}};
+
+	size_t leaf_size;
+
+	// currently filled leaf
+	Hasher leaf{};
+	size_t leaf_used{0u};
+
+	// perfect subtrees waiting for their sibling: bit k of `leaves` means `stack[k]` covers 2^k leaves
+	uint64_t leaves{0u};
+	std::array<result_t, max_levels> stack{};
+	uint64_t zero_mask{0u}; // which subtrees in `stack` contain only zero leaves
+
+	// zero[k] is digest of subtree with 2^k zero leaves
+	std::array<result_t, max_levels> zero{};
+	size_t zero_known{0u};
+
+	uint64_t zero_leaves{0u}; // number of leaves which weren't hashed
+
+	explicit constexpr merkle_hasher(size_t leaf_sz = 4096u) noexcept: leaf_size{leaf_sz} {
+		CTHASH_ASSERT(leaf_size != 0u);
+	}
+
+	// zero subtrees are taken from table shared by hashers with same leaf size
+	explicit constexpr merkle_hasher(const merkle_zero_subtrees<Hasher> & zeros) noexcept: leaf_size{zeros.leaf_size}, zero{zeros.digests}, zero_known{max_levels} { }
+
+	constexpr merkle_hasher & update(std::span<const std::byte> in) noexcept {
+		while (!in.empty()) {
+			// whole leaf is available in input
+			if (leaf_used == 0u && in.size() >= leaf_size) {
+				const auto block = in.first(leaf_size);
+
+				if (internal::is_all_zero(block)) {
+					push(0u, zero_subtree(0u), true);
+					++zero_leaves;
+				} else {
+					push(0u, Hasher{}.update(std::span(leaf_prefix)).update(block).final(), false);
+				}
+
+				in = in.subspan(leaf_size);
+				continue;
+			}
+
+			const size_t n = std::min(in.size(), leaf_size - leaf_used);
+			feed(in.first(n));
+			in = in.subspan(n);
+		}
+
+		return *this;
+	}
+
+	// append `length` zero bytes (holes of sparse files) without touching them
+	constexpr merkle_hasher & update_zeros(uint64_t length) noexcept {
+		if (leaf_used != 0u) {
+			const size_t n = static_cast<size_t>(std::min<uint64_t>(length, leaf_size - leaf_used));
+			feed_zeros(n);
+			length -= n;
+		}
+
+		add_zero_leaves(length / leaf_size);
+		feed_zeros(static_cast<size_t>(length % leaf_size));
+
+		return *this;
+	}
+
+	constexpr auto final() noexcept -> result_t {
+		if (leaf_used != 0u) {
+			push(0u, leaf.final(), false);
+			leaf_used = 0u;
+		}
+
+		// digest of empty tree is digest of empty input
+		if (leaves == 0u) {
+			return Hasher{}.final();
+		}
+
+		// remaining subtrees are joined from the smallest (rightmost) one
+		result_t output{};
+		bool first = true;
+
+		for (size_t k = 0; k != max_levels; ++k) {
+			if (((leaves >> k) & 1u) == 0u) {
+				continue;
+			}
+
+			output = first ? stack[k] : node(stack[k], output);
+			first = false;
+		}
+
+		return output;
+	}
+
+private:
+	friend struct merkle_zero_subtrees<Hasher>;
+
+	static constexpr auto node(const result_t & lhs, const result_t & rhs) noexcept -> result_t {
+		return Hasher{}.update(std::span(node_prefix)).update(std::span<const std::byte>(lhs)).update(std::span<const std::byte>(rhs)).final();
+	}
+
+	constexpr auto zero_subtree(size_t level) noexcept -> const result_t & {
+		if (zero_known == 0u) {
+			constexpr std::array<std::byte, 512> zeros{};
+
+			Hasher h{};
+			h.update(std::span(leaf_prefix));
+
+			for (size_t remaining = leaf_size; remaining != 0u;) {
+				const size_t n = std::min(remaining, zeros.size());
+				h.update(std::span(zeros).first(n));
+				remaining -= n;
+			}
+
+			zero[0] = h.final();
+			zero_known = 1u;
+		}
+
+		for (; zero_known <= level; ++zero_known) {
+			zero[zero_known] = node(zero[zero_known - 1u], zero[zero_known - 1u]);
+		}
+
+		return zero[level];
+	}
+
+	constexpr void feed(std::span<const std::byte> in) noexcept {
+		if (leaf_used == 0u) {
+			// not all hashers are assignable
+			std::destroy_at(&leaf);
+			std::construct_at(&leaf);
+			leaf.update(std::span(leaf_prefix));
+		}
+
+		leaf.update(in);
+		leaf_used += in.size();
+
+		if (leaf_used == leaf_size) {
+			push(0u, leaf.final(), false);
+			leaf_used = 0u;
+		}
+	}
+
+	constexpr void feed_zeros(size_t n) noexcept {
+		constexpr std::array<std::byte, 512> zeros{};
+
+		while (n != 0u) {
+			const size_t chunk = std::min(n, zeros.size());
+			feed(std::span(zeros).first(chunk));
+			n -= chunk;
+		}
+	}
+
+	// largest aligned perfect subtrees of zero leaves
+	constexpr void add_zero_leaves(uint64_t count) noexcept {
+		zero_leaves += count;
+
+		while (count != 0u) {
+			const size_t fits = static_cast<size_t>(std::bit_width(count) - 1u);
+			const size_t aligned = (leaves == 0u) ? max_levels - 1u : static_cast<size_t>(std::countr_zero(leaves));
+			const size_t level = std::min(fits, aligned);
+
+			push(level, zero_subtree(level), true);
+			count -= uint64_t{1} << level;
+		}
+	}
+
+	// add perfect subtree with 2^level leaves (number of leaves must be multiple of its size)
+	constexpr void push(size_t level, result_t value, bool zeros) noexcept {
+		CTHASH_ASSERT(level < max_levels);
+		CTHASH_ASSERT((leaves & ((uint64_t{1} << level) - 1u)) == 0u);
+
+		const uint64_t before = leaves;
+		leaves += uint64_t{1} << level;
+
+		// carry joins subtrees of same size
+		for (; ((before >> level) & 1u) != 0u; ++level) {
+			const bool both_zero = zeros && ((zero_mask >> level) & 1u) != 0u;
+			value = both_zero ? zero_subtree(level + 1u) : node(stack[level], value);
+			zeros = both_zero;
+			zero_mask &= ~(uint64_t{1} << level);
+		}
+
+		stack[level] = value;
+		zero_mask = zeros ? (zero_mask | (uint64_t{1} << level)) : (zero_mask & ~(uint64_t{1} << level));
+	}
+};
+
+// digests of zero subtrees of all levels for one leaf size, so they are computed once and not for each hasher
+template <typename Hasher> struct merkle_zero_subtrees {
+	using result_t = typename merkle_hasher<Hasher>::result_t;
+
+	size_t leaf_size;
+	std::array<result_t, merkle_hasher<Hasher>::max_levels> digests{};
+
+	explicit constexpr merkle_zero_subtrees(size_t leaf_sz) noexcept: leaf_size{leaf_sz} {
+		auto h = merkle_hasher<Hasher>{leaf_sz};
+		h.zero_subtree(digests.size() - 1u);
+		digests = h.zero;
+	}
+};
+
+} // namespace cthash
+
+#endif
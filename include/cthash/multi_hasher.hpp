@@ -0,0 +1,74 @@
+#ifndef CTHASH_MULTI_HASHER_HPP
+#define CTHASH_MULTI_HASHER_HPP
+
+#include "hasher.hpp"
+#include <algorithm>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <cstddef>
+
+namespace cthash {
+
+// size of part of input which is given to each member while it's still in cache
+constexpr size_t multi_hasher_tile_size = 32u * 1024u;
+
+// calculates multiple digests in a single pass over input
+template <typename... Hashers> struct multi_hasher {
+	static_assert(sizeof...(Hashers) > 0u);
+	static_assert(((Hashers::result_t::digest_length != 0u) && ...), "only hashers with fixed digest length are supported");
+
+	using result_t = std::tuple<typename Hashers::result_t...>;
+
+	static constexpr size_t tile_size = multi_hasher_tile_size;
+
+	std::tuple<Hashers...> members{};
+	size_t total_length{0u};
+
+	constexpr multi_hasher() noexcept = default;
+	constexpr multi_hasher(const multi_hasher &) noexcept = default;
+	constexpr multi_hasher(multi_hasher &&) noexcept = default;
+	constexpr ~multi_hasher() noexcept = default;
+
+	template <byte_like T> constexpr multi_hasher & update_tiles(std::span<const T> input) noexcept {
+		total_length += input.size();
+
+		while (!input.empty()) {
+			const auto tile = input.first(std::min(input.size(), tile_size));
+			std::apply([tile](auto &... h) { (h.update(tile), ...); }, members);
+			input = input.subspan(tile.size());
+		}
+
+		return *this;
+	}
+
+	// support for various input types
+	constexpr multi_hasher & update(std::span<const std::byte> input) noexcept {
+		return update_tiles(input);
+	}
+
+	template <convertible_to_byte_span T> constexpr multi_hasher & update(const T & something) noexcept {
+		using value_type = typename decltype(std::span(something))::value_type;
+		return update_tiles(std::span<const value_type>(something));
+	}
+
+	template <one_byte_char CharT> constexpr multi_hasher & update(std::basic_string_view<CharT> in) noexcept {
+		return update_tiles(std::span(in.data(), in.size()));
+	}
+
+	template <string_literal T> constexpr multi_hasher & update(const T & lit) noexcept {
+		return update_tiles(std::span(lit, std::size(lit) - 1u));
+	}
+
+	constexpr auto final() noexcept -> result_t {
+		return std::apply([](auto &... h) { return result_t{h.final()...}; }, members);
+	}
+
+	constexpr size_t size() const noexcept {
+		return total_length;
+	}
+};
+
+} // namespace cthash
+
+#endif
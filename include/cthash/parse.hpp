@@ -0,0 +1,120 @@
+#ifndef CTHASH_PARSE_HPP
+#define CTHASH_PARSE_HPP
+
+#include "value.hpp"
+#include "internal/hexdec.hpp"
+#include <algorithm>
+#include <span>
+#include <string_view>
+#include <variant>
+#include <vector>
+#include <cstddef>
+
+namespace cthash {
+
+// runtime parsing of hexadecimal digests with validation (compile-time literals don't validate)
+
+enum class parse_error_reason {
+	invalid_length,
+	invalid_character,
+};
+
+struct parse_error {
+	parse_error_reason reason;
+	size_t position; // offset of invalid character (or of whole digest when its length is wrong)
+
+	constexpr friend bool operator==(const parse_error &, const parse_error &) noexcept = default;
+};
+
+// value or error (subset of std::expected interface)
+template <typename T> struct parse_result {
+	std::variant<T, parse_error> storage;
+
+	constexpr parse_result(const T & value) noexcept: storage{std::in_place_index<0>, value} { }
+	constexpr parse_result(const parse_error & error) noexcept: storage{std::in_place_index<1>, error} { }
+
+	constexpr bool has_value() const noexcept {
+		return storage.index() == 0u;
+	}
+
+	explicit constexpr operator bool() const noexcept {
+		return has_value();
+	}
+
+	constexpr const T & value() const {
+		return std::get<0>(storage);
+	}
+
+	constexpr const parse_error & error() const {
+		return std::get<1>(storage);
+	}
+
+	constexpr const T & operator*() const noexcept {
+		return *std::get_if<0>(&storage);
+	}
+
+	constexpr const T * operator->() const noexcept {
+		return std::get_if<0>(&storage);
+	}
+};
+
+template <typename Config> constexpr auto parse_hash(std::string_view in) noexcept -> parse_result<tagged_hash_value<Config>> {
+	using value_t = tagged_hash_value<Config>;
+
+	if (in.size() != value_t::digest_length * 2u) {
+		return parse_error{parse_error_reason::invalid_length, 0u};
+	}
+
+	value_t output{};
+
+	if (const size_t pos = internal::decode_hexdec(std::span<const char>(in), output.data()); pos != in.size()) {
+		return parse_error{parse_error_reason::invalid_character, pos};
+	}
+
+	return output;
+}
+
+template <typename Value> struct parsed_hashes {
+	std::vector<Value> values;
+	std::vector<parse_error> errors; // positions are offsets in whole input
+
+	constexpr bool ok() const noexcept {
+		return errors.empty();
+	}
+};
+
+// one digest per line (LF or CRLF), empty lines are skipped and so are lines with errors
+template <typename Config> constexpr auto parse_hashes(std::string_view in) -> parsed_hashes<tagged_hash_value<Config>> {
+	using value_t = tagged_hash_value<Config>;
+
+	parsed_hashes<value_t> output;
+	output.values.reserve(in.size() / (value_t::digest_length * 2u + 1u) + 1u);
+
+	for (size_t offset = 0u; offset < in.size();) {
+		const size_t end = std::min(in.find('\n', offset), in.size());
+		auto line = in.substr(offset, end - offset);
+
+		if (!line.empty() && line.back() == '\r') {
+			line.remove_suffix(1u);
+		}
+
+		if (line.size() == value_t::digest_length * 2u) {
+			value_t & value = output.values.emplace_back();
+
+			if (const size_t pos = internal::decode_hexdec(std::span<const char>(line), value.data()); pos != line.size()) {
+				output.values.pop_back();
+				output.errors.push_back(parse_error{parse_error_reason::invalid_character, offset + pos});
+			}
+		} else if (!line.empty()) {
+			output.errors.push_back(parse_error{parse_error_reason::invalid_length, offset});
+		}
+
+		offset = end + 1u;
+	}
+
+	return output;
+}
+
+} // namespace cthash
+
+#endif
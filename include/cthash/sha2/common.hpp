@@ -57,6 +57,42 @@ template <typename Config, typename StageT, size_t StageLength, typename StateT,
 	}
 }
 
+// same as `rounds` but over multiple independent states (lanes) at once, lanes are the inner dimension so it can be vectorized
+template <typename Config, typename StageT, size_t Lanes, size_t StageLength, typename StateT, size_t StateLength>
+[[gnu::always_inline]] constexpr void rounds_lanes(const std::array<std::array<StageT, Lanes>, StageLength> & w, std::array<std::array<StateT, Lanes>, StateLength> & state) noexcept {
+	// create copy of internal state
+	auto wvar = state;
+
+	// just give them names
+	auto & [a, b, c, d, e, f, g, h] = wvar;
+
+	// number of rounds is same as constants
+	static_assert(StageLength == Config::constants.size());
+
+	for (int i = 0; i != Config::constants.size(); ++i) {
+		for (size_t l = 0; l != Lanes; ++l) {
+			const auto temp1 = h[l] + Config::sum_e(e[l]) + choice(e[l], f[l], g[l]) + Config::constants[i] + w[i][l];
+			const auto temp2 = Config::sum_a(a[l]) + majority(a[l], b[l], c[l]);
+
+			h[l] = g[l];
+			g[l] = f[l];
+			f[l] = e[l];
+			e[l] = d[l] + temp1;
+			d[l] = c[l];
+			c[l] = b[l];
+			b[l] = a[l];
+			a[l] = temp1 + temp2;
+		}
+	}
+
+	// add store back
+	for (int i = 0; i != (int)state.size(); ++i) {
+		for (size_t l = 0; l != Lanes; ++l) {
+			state[i][l] += wvar[i][l];
+		}
+	}
+}
+
 } // namespace cthash::sha2
 
 #endif
\ No newline at end of file
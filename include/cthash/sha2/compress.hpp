@@ -0,0 +1,66 @@
+#ifndef CTHASH_SHA2_COMPRESS_HPP
+#define CTHASH_SHA2_COMPRESS_HPP
+
+#include "common.hpp"
+#include "../internal/assert.hpp"
+#include "../internal/lanes.hpp"
+#include <span>
+
+// raw SHA-2 compression function for custom constructions (merkle trees, ...), there is no buffering
+// and no padding, use `hasher` if you want to hash a message
+
+namespace cthash::sha2 {
+
+template <typename Config> using state_of = typename internal_hasher<Config>::state_value_t;
+
+template <typename Config> constexpr size_t block_size_of = internal_hasher<Config>::block_size_bytes;
+
+template <typename Config> constexpr auto initial_state() noexcept -> state_of<Config> {
+	return Config::initial_values;
+}
+
+// compress consecutive blocks into state (size of input must be multiple of block size)
+template <typename Config> constexpr void compress(state_of<Config> & state, std::span<const std::byte> blocks) noexcept {
+	CTHASH_ASSERT(blocks.size() % block_size_of<Config> == 0u);
+	internal_hasher<Config>::compress(state, blocks.data(), blocks.size() / block_size_of<Config>);
+}
+
+// compress independent states each with its own blocks, states are processed together in lanes
+template <typename Config> constexpr void compress(std::span<state_of<Config>> states, std::span<const std::span<const std::byte>> blocks) noexcept {
+	using kernel = internal_hasher<Config>;
+
+	CTHASH_ASSERT(states.size() == blocks.size());
+
+	internal::lanes_engine<kernel> engine{};
+
+	const auto store = [&](const typename internal::lanes_engine<kernel>::message_t & msg) {
+		states[msg.id] = msg.state;
+	};
+
+	for (size_t i = 0; i != states.size(); ++i) {
+		CTHASH_ASSERT(blocks[i].size() % block_size_of<Config> == 0u);
+
+		if (blocks[i].empty()) {
+			continue;
+		}
+
+		if (engine.full()) {
+			engine.step(store);
+		}
+
+		engine.start_blocks(i, states[i], blocks[i].data(), blocks[i].size() / block_size_of<Config>);
+	}
+
+	engine.drain(store);
+}
+
+// write big-endian digest from state (truncated to digest length of `Config`)
+template <typename Config> constexpr auto digest_of(const state_of<Config> & state) noexcept -> typename internal_hasher<Config>::result_t {
+	typename internal_hasher<Config>::result_t output;
+	internal_hasher<Config>::write_lane_result_into(state, output);
+	return output;
+}
+
+} // namespace cthash::sha2
+
+#endif
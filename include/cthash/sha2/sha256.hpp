@@ -46,6 +46,10 @@ struct sha256_config {
 	[[gnu::always_inline]] static constexpr void rounds(std::span<const uint32_t, 64> w, std::array<uint32_t, 8> & state) noexcept {
 		return sha2::rounds<sha256_config>(w, state);
 	}
+
+	template <size_t Lanes> [[gnu::always_inline]] static constexpr void rounds_lanes(const std::array<std::array<uint32_t, Lanes>, 64> & w, std::array<std::array<uint32_t, Lanes>, 8> & state) noexcept {
+		return sha2::rounds_lanes<sha256_config>(w, state);
+	}
 };
 
 static_assert(not cthash::internal::digest_length_provided<sha256_config>);
@@ -53,6 +53,10 @@ struct sha512_config {
 	[[gnu::always_inline]] static constexpr void rounds(std::span<const uint64_t, 80> w, std::array<uint64_t, 8> & state) noexcept {
 		return sha2::rounds<sha512_config>(w, state);
 	}
+
+	template <size_t Lanes> [[gnu::always_inline]] static constexpr void rounds_lanes(const std::array<std::array<uint64_t, Lanes>, 80> & w, std::array<std::array<uint64_t, Lanes>, 8> & state) noexcept {
+		return sha2::rounds_lanes<sha512_config>(w, state);
+	}
 };
 
 static_assert(not cthash::internal::digest_length_provided<sha512_config>);
@@ -122,19 +122,7 @@ template <typename Config> struct basic_keccak_hasher {
 
 	// inserting blocks of `rate` into the hash internal state
 	template <byte_like T> constexpr auto absorb(std::span<const T, rate> input) noexcept {
-		using value_t = keccak::state_1600::value_type;
-
-		// fill the `rate` part
-		static_assert(rate % sizeof(value_t) == 0u);
-
-		for (int i = 0; i < int(rate); i += sizeof(value_t)) {
-			const auto part = input.subspan(size_t(i)).template first<sizeof(value_t)>();
-			const value_t v = cast_from_le_bytes<value_t>(part);
-
-			internal_state[i / sizeof(value_t)] ^= v;
-		}
-
-		// filling `capacity` part is no-op
+		xor_block_into(internal_state, input);
 
 		// and call keccak
 		keccak_f(internal_state);
@@ -169,13 +157,8 @@ template <typename Config> struct basic_keccak_hasher {
 		}
 	}
 
-	// pad the message
-	constexpr void final_absorb() noexcept {
-		// TODO support longer suffixes
-		CTHASH_ASSERT(!buffer.full());
-
-		const auto suffix_and_padding = buffer.remaining_space();
-
+	// write suffix and padding into unused end of the block
+	static constexpr void write_padding(std::span<std::byte> suffix_and_padding) noexcept {
 		constexpr const auto & suffix = Config::suffix;
 		static_assert(suffix.values.size() == 1u, "longer suffix is not implemented");
 		CTHASH_ASSERT(Config::suffix.bits <= 5);
@@ -190,10 +173,108 @@ template <typename Config> struct basic_keccak_hasher {
 		// front and back can be the same
 		suffix_and_padding.front() = suffix.values[0] | (std::byte{0b0000'0001u} << suffix.bits);
 		suffix_and_padding.back() |= std::byte{0b1000'0000u};
+	}
+
+	// pad the message
+	constexpr void final_absorb() noexcept {
+		// TODO support longer suffixes
+		CTHASH_ASSERT(!buffer.full());
+
+		write_padding(buffer.remaining_space());
 
 		absorb(buffer.storage);
 	}
 
+	// multi-buffer support (independent messages are processed in lanes)
+	static constexpr size_t lanes = keccak::preferred_lanes;
+	static constexpr size_t block_size_bytes = rate;
+
+	using lane_state_t = keccak::state_1600;
+	using final_blocks_t = std::array<std::byte, rate>;
+
+	static constexpr auto initial_lane_state() noexcept -> lane_state_t {
+		lane_state_t output;
+		std::fill(output.begin(), output.end(), uint64_t{0});
+		return output;
+	}
+
+	// number of blocks needed to process message of `length` bytes including padding
+	static constexpr size_t padded_blocks_count(size_t length) noexcept {
+		return length / rate + 1u;
+	}
+
+	// prepare padded last block from unprocessed remainder of message
+	static constexpr size_t build_final_blocks(std::span<const std::byte> tail, size_t, final_blocks_t & out) noexcept {
+		CTHASH_ASSERT(tail.size() < rate);
+
+		std::copy(tail.begin(), tail.end(), out.begin());
+		write_padding(std::span<std::byte>(out).subspan(tail.size()));
+		return 1u;
+	}
+
+	template <byte_like T> [[gnu::always_inline]] static constexpr void xor_block_into(keccak::state_1600 & state, std::span<const T, rate> input) noexcept {
+		using value_t = keccak::state_1600::value_type;
+
+		// fill the `rate` part
+		static_assert(rate % sizeof(value_t) == 0u);
+
+		for (int i = 0; i < int(rate); i += sizeof(value_t)) {
+			const auto part = input.subspan(size_t(i)).template first<sizeof(value_t)>();
+			const value_t v = cast_from_le_bytes<value_t>(part);
+
+			state[i / sizeof(value_t)] ^= v;
+		}
+
+		// filling `capacity` part is no-op
+	}
+
+	// absorb `count` consecutive blocks of each lane (every lane has its own state and input)
+	template <size_t Lanes> static constexpr void compress_lanes(const std::array<lane_state_t *, Lanes> & states, std::array<const std::byte *, Lanes> blocks, size_t count) noexcept {
+		using value_t = keccak::state_1600::value_type;
+
+		keccak::state_1600_lanes<Lanes> transposed;
+
+		for (size_t i = 0; i != transposed.size(); ++i) {
+			for (size_t l = 0; l != Lanes; ++l) {
+				transposed[i][l] = (*states[l])[i];
+			}
+		}
+
+		for (; count != 0u; --count) {
+			for (size_t i = 0; i != rate / sizeof(value_t); ++i) {
+				for (size_t l = 0; l != Lanes; ++l) {
+					transposed[i][l] ^= cast_from_le_bytes<value_t>(std::span<const std::byte, sizeof(value_t)>(blocks[l] + i * sizeof(value_t), sizeof(value_t)));
+				}
+			}
+
+			keccak_f(transposed);
+
+			for (auto & ptr: blocks) {
+				ptr += rate;
+			}
+		}
+
+		for (size_t i = 0; i != transposed.size(); ++i) {
+			for (size_t l = 0; l != Lanes; ++l) {
+				(*states[l])[i] = transposed[i][l];
+			}
+		}
+	}
+
+	static constexpr void compress(lane_state_t & state, const std::byte * blocks, size_t count) noexcept {
+		for (; count != 0u; --count) {
+			xor_block_into(state, std::span<const std::byte, rate>(blocks, rate));
+			keccak_f(state);
+			blocks += rate;
+		}
+	}
+
+	static constexpr void write_lane_result_into(const lane_state_t & state, std::span<std::byte> out) noexcept {
+		basic_keccak_hasher tmp;
+		tmp.internal_state = state;
+		tmp.squeeze(out);
+	}
+
 	// get resulting hash
 	constexpr void squeeze(std::span<std::byte> output) noexcept {
 		using value_t = keccak::state_1600::value_type;
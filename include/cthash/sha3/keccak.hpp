@@ -88,6 +88,111 @@ struct state_1600_ref: std::span<uint64_t, (5u * 5u)> {
 	};
 }
 
+// multi-buffer variant: each word of the state is a vector of independent states (lanes)
+
+// vectorized keccak-f wasn't faster than scalar one in measurements (not even with AVX-512), so batch
+// APIs process SHA-3 messages one by one, lanes variant below stays available for explicit lane count
+constexpr size_t preferred_lanes = 1u;
+
+template <size_t Lanes> struct state_1600_lanes: std::array<std::array<uint64_t, Lanes>, (5u * 5u)> { };
+
+template <size_t Lanes> [[gnu::always_inline]] constexpr void theta(state_1600_lanes<Lanes> & state) noexcept {
+	std::array<std::array<uint64_t, Lanes>, 5> b;
+
+	// xor of columns
+	for (size_t x = 0; x != 5u; ++x) {
+		for (size_t l = 0; l != Lanes; ++l) {
+			b[x][l] = state[x][l] xor state[x + 5u][l] xor state[x + 10u][l] xor state[x + 15u][l] xor state[x + 20u][l];
+		}
+	}
+
+	std::array<std::array<uint64_t, Lanes>, 5> tmp;
+
+	for (size_t x = 0; x != 5u; ++x) {
+		for (size_t l = 0; l != Lanes; ++l) {
+			tmp[x][l] = b[(x + 4u) % 5u][l] xor std::rotl(b[(x + 1u) % 5u][l], 1);
+		}
+	}
+
+	for (size_t i = 0; i != 25u; ++i) {
+		for (size_t l = 0; l != Lanes; ++l) {
+			state[i][l] ^= tmp[i % 5u][l];
+		}
+	}
+}
+
+template <size_t Lanes> [[gnu::always_inline]] constexpr void rho_pi(state_1600_lanes<Lanes> & state) noexcept {
+	std::array<uint64_t, Lanes> tmp = state[1];
+
+	for (size_t i = 0; i != pi.size(); ++i) {
+		const std::array<uint64_t, Lanes> current = state[pi[i]];
+
+		for (size_t l = 0; l != Lanes; ++l) {
+			state[pi[i]][l] = std::rotl(tmp[l], rho[i]);
+		}
+
+		tmp = current;
+	}
+}
+
+template <size_t Lanes> [[gnu::always_inline]] constexpr void chi(state_1600_lanes<Lanes> & state) noexcept {
+	for (size_t y = 0; y != 25u; y += 5u) {
+		const auto b = std::array<std::array<uint64_t, Lanes>, 5>{state[y], state[y + 1u], state[y + 2u], state[y + 3u], state[y + 4u]};
+
+		for (size_t x = 0; x != 5u; ++x) {
+			for (size_t l = 0; l != Lanes; ++l) {
+				state[y + x][l] = b[x][l] xor ((~b[(x + 1u) % 5u][l]) bitand b[(x + 2u) % 5u][l]);
+			}
+		}
+	}
+}
+
+template <size_t Lanes> [[gnu::flatten]] constexpr void keccak_f(state_1600_lanes<Lanes> & state) noexcept {
+	for (int i = 0; i != 24; ++i) {
+		theta(state);
+		rho_pi(state);
+		chi(state);
+
+		for (size_t l = 0; l != Lanes; ++l) {
+			state[0][l] ^= rc[i];
+		}
+	}
+}
+
+// Keccak-f[1600] permutation (public entry point for custom sponge constructions)
+constexpr void permute(state_1600 & state) noexcept {
+	keccak_f(state);
+}
+
+// permute independent states, groups of `preferred_lanes` states are processed together
+constexpr void permute(std::span<state_1600> states) noexcept {
+	if constexpr (preferred_lanes > 1u) {
+		while (states.size() >= preferred_lanes) {
+			state_1600_lanes<preferred_lanes> transposed;
+
+			for (size_t i = 0; i != transposed.size(); ++i) {
+				for (size_t l = 0; l != preferred_lanes; ++l) {
+					transposed[i][l] = states[l][i];
+				}
+			}
+
+			keccak_f(transposed);
+
+			for (size_t i = 0; i != transposed.size(); ++i) {
+				for (size_t l = 0; l != preferred_lanes; ++l) {
+					states[l][i] = transposed[i][l];
+				}
+			}
+
+			states = states.subspan(preferred_lanes);
+		}
+	}
+
+	for (state_1600 & state: states) {
+		keccak_f(state);
+	}
+}
+
 } // namespace cthash::keccak
 
-#endif
\ No newline at end of file
+#endif
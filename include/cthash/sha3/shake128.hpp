@@ -32,15 +32,13 @@ template <size_t N> struct shake128_value: tagged_hash_value<variable_bit_length
 	template <size_t K> constexpr friend bool operator==(const shake128_value & lhs, const shake128_value<K> & rhs) noexcept {
 		static_assert(K > 0);
 		constexpr auto smallest_n = std::min(N, K);
-		const auto lhs_view = std::span<const std::byte, smallest_n / 8u>(lhs.data(), smallest_n / 8u);
-		const auto rhs_view = std::span<const std::byte, smallest_n / 8u>(rhs.data(), smallest_n / 8u);
-		return std::equal(lhs_view.begin(), lhs_view.end(), rhs_view.begin());
+		return internal::equal_bytes<smallest_n / 8u>(lhs.data(), rhs.data());
 	}
 
 	template <size_t K> constexpr friend auto operator<=>(const shake128_value & lhs, const shake128_value<K> & rhs) noexcept {
 		static_assert(K > 0);
 		constexpr auto smallest_n = std::min(N, K);
-		return internal::threeway_compare_of_same_size(lhs.data(), rhs.data(), smallest_n / 8u);
+		return internal::compare_bytes<smallest_n / 8u>(lhs.data(), rhs.data());
 	}
 };
 
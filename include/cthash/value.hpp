@@ -6,9 +6,17 @@
 #include "internal/fixed-string.hpp"
 #include "internal/hexdec.hpp"
 #include <array>
+#include <charconv>
 #include <span>
 #include <string_view>
+#include <system_error>
+#include <version>
 #include <compare>
+#include <functional>
+#if __cpp_lib_format >= 201907L
+#include <algorithm>
+#include <format>
+#endif
 
 namespace cthash {
 
@@ -23,17 +31,45 @@ template <size_t N> struct hash_value: std::array<std::byte, N> {
 	template <typename CharT> explicit constexpr hash_value(const internal::fixed_string<CharT, N * 2u> & in) noexcept: super{internal::hexdec_to_binary<N>(std::span<const CharT, N * 2u>(in.data(), in.size()))} { }
 
 	// comparison support
-	constexpr friend bool operator==(const hash_value & lhs, const hash_value & rhs) noexcept = default;
+	constexpr friend bool operator==(const hash_value & lhs, const hash_value & rhs) noexcept {
+		return internal::equal_bytes<N>(lhs.data(), rhs.data());
+	}
 	constexpr friend auto operator<=>(const hash_value & lhs, const hash_value & rhs) noexcept -> std::strong_ordering {
-		return internal::threeway_compare_of_same_size(lhs.data(), rhs.data(), N);
+		return internal::compare_bytes<N>(lhs.data(), rhs.data());
+	}
+
+	// hexadecimal representation without allocation, returns written part (empty if output is too short)
+	template <typename CharT, size_t Extent> constexpr auto to_hex(std::span<CharT, Extent> out, bool upper = false) const noexcept -> std::span<CharT> {
+		if (out.size() < N * 2u) {
+			return {};
+		}
+
+		internal::encode_hexdec(std::span<const std::byte>(*this), out.data(), upper);
+		return out.first(N * 2u);
+	}
+
+	constexpr friend auto to_chars(char * first, char * last, const hash_value & val) noexcept -> std::to_chars_result {
+		if (static_cast<size_t>(last - first) < N * 2u) {
+			return {last, std::errc::value_too_large};
+		}
+
+		internal::encode_hexdec(std::span<const std::byte>(val), first);
+		return {first + N * 2u, std::errc{}};
 	}
 
 	// print to ostream support
 	template <typename CharT, typename Traits> constexpr friend auto & operator<<(std::basic_ostream<CharT, Traits> & os, const hash_value & val) {
-		return internal::push_to_stream_as<internal::byte_hexdec_value>(val.begin(), val.end(), os);
+		std::array<CharT, N * 2u> buffer;
+		internal::encode_hexdec(std::span<const std::byte>(val), buffer.data());
+		return os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
 	}
 };
 
+// for secrets (MAC tags), time doesn't depend on position of first difference
+template <size_t N> constexpr bool verify_equal(const hash_value<N> & lhs, const hash_value<N> & rhs) noexcept {
+	return internal::constant_time_equal_bytes<N>(lhs.data(), rhs.data());
+}
+
 template <typename CharT, size_t N> hash_value(const CharT (&)[N]) -> hash_value<(N - 1u) / 2u>;
 template <typename CharT, size_t N> hash_value(std::span<const CharT, N>) -> hash_value<N / 2u>;
 template <typename CharT, size_t N> hash_value(const internal::fixed_string<CharT, N> &) -> hash_value<N / 2u>;
@@ -65,4 +101,43 @@ namespace literals {
 
 } // namespace cthash
 
+// digests are already uniformly distributed, so their first bytes are used directly
+template <size_t N> struct std::hash<cthash::hash_value<N>> {
+	constexpr size_t operator()(const cthash::hash_value<N> & value) const noexcept {
+		return static_cast<size_t>(cthash::internal::prefix_word<N>(value.data()));
+	}
+};
+
+template <typename Tag, size_t N> struct std::hash<cthash::tagged_hash_value<Tag, N>>: std::hash<cthash::hash_value<N>> { };
+
+#if __cpp_lib_format >= 201907L
+// format spec is empty, `x` (default) or `X` for uppercase digits
+template <size_t N, typename CharT> struct std::formatter<cthash::hash_value<N>, CharT> {
+	bool upper{false};
+
+	constexpr auto parse(std::basic_format_parse_context<CharT> & ctx) {
+		auto it = ctx.begin();
+
+		if (it != ctx.end() && (*it == CharT('x') || *it == CharT('X'))) {
+			upper = (*it == CharT('X'));
+			++it;
+		}
+
+		if (it != ctx.end() && *it != CharT('}')) {
+			throw std::format_error("invalid format specification of hash_value");
+		}
+
+		return it;
+	}
+
+	template <typename FormatContext> auto format(const cthash::hash_value<N> & val, FormatContext & ctx) const {
+		std::array<CharT, N * 2u> buffer;
+		cthash::internal::encode_hexdec(std::span<const std::byte>(val), buffer.data(), upper);
+		return std::copy(buffer.begin(), buffer.end(), ctx.out());
+	}
+};
+
+template <typename Tag, size_t N, typename CharT> struct std::formatter<cthash::tagged_hash_value<Tag, N>, CharT>: std::formatter<cthash::hash_value<N>, CharT> { };
+#endif
+
 #endif
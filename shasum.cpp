@@ -1,115 +1,995 @@
-#include <cthash/cthash.hpp>
+#include "shasum/algorithms.hpp"
+#include "shasum/bench.hpp"
+#include "shasum/cache.hpp"
+#include "shasum/decompress.hpp"
+#include "shasum/input.hpp"
+#include "shasum/manifest.hpp"
+#include "shasum/pool.hpp"
+#include "shasum/small_files.hpp"
+#include "shasum/sparse.hpp"
+#include "shasum/stream_reader.hpp"
+#include "shasum/tar.hpp"
+#include "shasum/tee.hpp"
+#include "shasum/tree.hpp"
+#include "shasum/watch.hpp"
+#include <atomic>
 #include <chrono>
-#include <fcntl.h>
-#include <sys/mman.h>
-#include <unistd.h>
-#include <iostream>
+#include <iterator>
+#include <charconv>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
 
-struct mapped_file {
-	static constexpr int invalid = -1;
+void print_usage(const char * self) {
+	std::cerr << self << " [-j N] hash file...\n";
+	std::cerr << self << " [-j N] -a hash[,hash...] file...\n";
+	std::cerr << "hash is one of: sha-224, sha-256, sha-384, sha-512, sha-512/224, sha-512/256, sha3-224, sha3-256, sha3-384, sha3-512, \n";
+	std::cerr << "  shake-128/n, shake-256/n (where n is 32/64/128/256/512/1024/2048)\n";
+	std::cerr << self << " [-j N] -c [--fail-fast] [hash] manifest...\n";
+	std::cerr << self << " [-j N] -r [--watch] hash directory\n";
+	std::cerr << self << " --diff [hash] old-manifest new-manifest\n";
+	std::cerr << self << " --bench [--json] [hash[,hash...]...]\n";
+	std::cerr << self << " --tee [--digest-to file] hash[,hash...]\n";
+	std::cerr << self << " --tar hash [archive]\n";
+	std::cerr << self << " [-j N] --decompress hash file...\n";
+	std::cerr << "file '-' is standard input, -j N hashes files in N threads\n";
+	std::cerr << "--cache file remembers digests of unchanged files, --watch keeps cache of directory updated\n";
+	std::cerr << "--tee copies standard input to standard output and prints digest to standard error (or file) at the end\n";
+	std::cerr << "--merkle N hashes files as merkle trees with leaves of N bytes (holes and zero leaves are not hashed)\n";
+	std::cerr << "--decompress prints also digest of decompressed content (supported: " << supported_compressions() << ")\n";
+	std::cerr << "--stream reads files with io_uring instead of mapping them (default for large files and block devices), --direct uses O_DIRECT (not with --merkle)\n";
+}
 
-	int fd{invalid};
-	size_t sz{0};
-	void * ptr{nullptr};
+struct options {
+	unsigned jobs{1u};
+	bool tagged{false};
+	bool check{false};
+	bool fail_fast{false};
+	bool recursive{false};
+	bool diff{false};
+	bool bench{false};
+	bool watch{false};
+	bool tee{false};
+	bool tar{false};
+	bool decompress{false};
+	size_t merkle_leaf{0}; // zero is plain hashing
+	std::string_view digest_path{};
+	std::string_view cache_path{};
+	digest_cache * cache{nullptr};
+	bool json{false};
+	bool force_stream{false};
+	stream_options stream{};
+	map_options map{};
+	small_files_options small{};
+	std::vector<const algorithm *> selected;
+	std::vector<std::string_view> paths;
+};
+
+auto parse_jobs(std::string_view arg) -> std::optional<unsigned> {
+	unsigned value = 0;
+	const auto [ptr, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), value);
+
+	if (ec != std::errc{} || ptr != arg.data() + arg.size() || value == 0u) {
+		return std::nullopt;
+	}
+
+	return value;
+}
+
+auto parse_options(int argc, char ** argv) -> std::optional<options> {
+	options opts;
+	int i = 1;
+
+	// switches are before hash and files
+	for (; i < argc; ++i) {
+		const auto arg = std::string_view(argv[i]);
+
+		if (arg == "-j" && i + 1 < argc) {
+			const auto jobs = parse_jobs(argv[++i]);
+			if (!jobs) {
+				std::cerr << "invalid number of jobs '" << argv[i] << "'!\n";
+				return std::nullopt;
+			}
+			opts.jobs = *jobs;
+		} else if (arg == "-c") {
+			opts.check = true;
+		} else if (arg == "-r") {
+			opts.recursive = true;
+		} else if (arg == "--diff") {
+			opts.diff = true;
+		} else if (arg == "--cache" && i + 1 < argc) {
+			opts.cache_path = argv[++i];
+		} else if (arg == "--tee") {
+			opts.tee = true;
+		} else if (arg == "--merkle" && i + 1 < argc) {
+			const auto leaf = parse_jobs(argv[++i]);
+			if (!leaf) {
+				std::cerr << "invalid leaf size '" << argv[i] << "'!\n";
+				return std::nullopt;
+			}
+			opts.merkle_leaf = *leaf;
+		} else if (arg == "--decompress") {
+			opts.decompress = true;
+		} else if (arg == "--tar") {
+			opts.tar = true;
+		} else if (arg == "--digest-to" && i + 1 < argc) {
+			opts.digest_path = argv[++i];
+		} else if (arg == "--watch") {
+			opts.watch = true;
+		} else if (arg == "--bench") {
+			opts.bench = true;
+		} else if (arg == "--json") {
+			opts.json = true;
+		} else if (arg == "--fail-fast") {
+			opts.fail_fast = true;
+		} else if (arg == "--stream") {
+			opts.force_stream = true;
+		} else if (arg == "--direct") {
+			opts.force_stream = true;
+			opts.stream.direct = true;
+		} else if (arg == "-a" && i + 1 < argc) {
+			auto list = parse_algorithms(argv[++i]);
+			if (!list) {
+				return std::nullopt;
+			}
+			opts.selected = std::move(*list);
+			opts.tagged = true;
+		} else {
+			break;
+		}
+	}
+
+	// benchmark all algorithms unless they are specified
+	if (opts.bench) {
+		for (; i < argc; ++i) {
+			auto list = parse_algorithms(argv[i]);
+			if (!list) {
+				return std::nullopt;
+			}
+			opts.selected.insert(opts.selected.end(), list->begin(), list->end());
+		}
 
-	static size_t get_size(int fd) {
-		if (fd == invalid) {
-			return 0;
+		if (opts.selected.empty()) {
+			for (const auto & a: algorithms) {
+				opts.selected.push_back(&a);
+			}
 		}
 
-		return (size_t)lseek(fd, 0, SEEK_END);
+		return opts;
 	}
 
-	mapped_file(const char * path): fd{open(path, O_RDONLY)}, sz{get_size(fd)}, ptr{mmap(nullptr, sz, PROT_READ, MAP_PRIVATE, fd, 0)} { }
+	// standard input is the only input and standard output is taken by data
+	if (opts.tee) {
+		if (!opts.tagged && i < argc) {
+			auto list = parse_algorithms(argv[i++]);
+			if (!list) {
+				return std::nullopt;
+			}
+			opts.selected = std::move(*list);
+		}
 
-	mapped_file(const mapped_file &) = delete;
-	mapped_file(mapped_file &&) = delete;
+		if (opts.selected.empty() || i != argc || opts.check || opts.recursive || opts.diff) {
+			return std::nullopt;
+		}
 
-	~mapped_file() {
-		if (ptr && fd != invalid) {
-			munmap(ptr, sz);
-			close(fd);
+		return opts;
+	}
+
+	// members and the archive are hashed with one algorithm, archive is standard input by default
+	if (opts.tar) {
+		if (opts.tagged || i == argc) {
+			return std::nullopt;
 		}
+
+		const algorithm * algo = find_algorithm(argv[i++]);
+
+		if (algo == nullptr || argc - i > 1 || opts.check || opts.recursive || opts.diff || opts.tee) {
+			return std::nullopt;
+		}
+
+		opts.selected.push_back(algo);
+		opts.paths.emplace_back(i < argc ? argv[i] : "-");
+		return opts;
+	}
+
+	// in check mode hash function is optional (manifest can be in BSD format)
+	if (opts.check || opts.diff) {
+		if (opts.tagged) {
+			return std::nullopt;
+		}
+
+		if (i + 1 < argc && find_algorithm(argv[i]) != nullptr) {
+			opts.selected.push_back(find_algorithm(argv[i++]));
+		}
+
+		for (; i < argc; ++i) {
+			opts.paths.emplace_back(argv[i]);
+		}
+
+		if (opts.paths.empty() || (opts.diff && opts.paths.size() != 2u)) {
+			return std::nullopt;
+		}
+
+		return opts;
+	}
+
+	// without -a first argument is the hash function
+	if (!opts.tagged && i < argc) {
+		auto list = parse_algorithms(argv[i++]);
+		if (!list) {
+			return std::nullopt;
+		}
+		opts.selected = std::move(*list);
+	}
+
+	for (; i < argc; ++i) {
+		opts.paths.emplace_back(argv[i]);
 	}
 
-	auto get_span() const noexcept {
-		return std::span<const std::byte>(reinterpret_cast<std::byte *>(ptr), sz);
+	if (opts.selected.empty() || opts.paths.empty()) {
+		return std::nullopt;
 	}
+
+	// tree digest is defined only for one algorithm and one tree
+	if (opts.recursive && (opts.selected.size() != 1u || opts.paths.size() != 1u)) {
+		return std::nullopt;
+	}
+
+	if (opts.watch && (!opts.recursive || opts.cache_path.empty())) {
+		return std::nullopt;
+	}
+
+	// compressed and decompressed content is hashed with the same algorithm
+	if (opts.decompress && (opts.selected.size() != 1u || opts.recursive)) {
+		return std::nullopt;
+	}
+
+	if (opts.merkle_leaf != 0u) {
+		if (opts.decompress) {
+			return std::nullopt;
+		}
+
+		for (const algorithm * a: opts.selected) {
+			if (a->create_merkle == nullptr) {
+				std::cerr << "merkle tree is not supported with '" << a->name << "'!\n";
+				return std::nullopt;
+			}
+		}
+	}
+
+	return opts;
+}
+
+// size of file is used only for scheduling, standard input is started first as it can't be split
+struct input_info {
+	uint64_t size{0};
+	bool regular{false};
 };
 
-int main(int argc, char ** argv) {
-	if (argc < 3) {
-		std::cerr << argv[0] << " hash file\n";
-		std::cerr << "hash is one of: sha-224, sha-256, sha-384, sha-512, sha-512/223, sha-512/256, sha3-224, sha3-256, sha3-384, sha3-512, \n";
-		std::cerr << "  shake-128/n, shake-256/n (where n is 32/64/128/256/512/1024/2048)\n";
-		return 1;
+input_info probe_input(std::string_view path) {
+	if (path == "-") {
+		return input_info{std::numeric_limits<uint64_t>::max(), false};
+	}
+
+	struct stat info {};
+	if (stat(std::string(path).c_str(), &info) != 0) {
+		return input_info{};
 	}
 
-	const auto h = std::string_view(argv[1]);
-	const auto f = mapped_file(argv[2]);
+	return input_info{static_cast<uint64_t>(info.st_size), S_ISREG(info.st_mode)};
+}
 
-	if (f.fd == mapped_file::invalid) {
-		std::cerr << "can't open file!\n";
-		return 1;
+// mapping files comparable with size of memory would only thrash page cache
+uint64_t streaming_threshold() {
+	static const uint64_t threshold = [] {
+		const long pages = sysconf(_SC_PHYS_PAGES);
+		const long page_size = sysconf(_SC_PAGE_SIZE);
+		if (pages <= 0 || page_size <= 0) {
+			return uint64_t{1} << 30u;
+		}
+		return static_cast<uint64_t>(pages) * static_cast<uint64_t>(page_size) / 4u;
+	}();
+	return threshold;
+}
+
+bool should_stream(const struct stat & info, const options & opts) {
+	if (S_ISBLK(info.st_mode)) {
+		return true;
+	}
+	return S_ISREG(info.st_mode) && (opts.force_stream || static_cast<uint64_t>(info.st_size) >= streaming_threshold());
+}
+
+// hash one input with all selected algorithms
+auto hash_input(std::string_view path, std::span<const algorithm * const> selected, const options & opts) -> std::optional<std::vector<digest>> {
+	std::vector<std::unique_ptr<any_hasher>> hashers;
+
+	// input is decompressed and its content hashed by other thread while compressed input is hashed here
+	std::optional<decompressing_hasher> decompressing;
+	bool decoded = true;
+
+	if (opts.decompress) {
+		decompressing.emplace(dynamic_hasher{selected.front()->create()}, dynamic_hasher{selected.front()->create()}, auto_decoder{});
+	}
+
+	const auto update = [&](std::span<const std::byte> chunk) {
+		if (decompressing) {
+			decoded = decompressing->update(chunk) && decoded;
+		} else {
+			update_in_tiles(chunk, hashers);
+		}
+	};
+
+	// standard input can be a redirected file too, so it's treated same as other files, sparse reading follows
+	// data extents which are not block aligned, so it can't use O_DIRECT
+	const bool is_stdin = (path == "-");
+	const int fd = is_stdin ? STDIN_FILENO : open_for_streaming(std::string(path).c_str(), opts.stream.direct && opts.merkle_leaf == 0u);
+
+	if (fd == -1) {
+		return std::nullopt;
+	}
+
+	struct stat info {};
+	bool success = fstat(fd, &info) == 0;
+
+	// unchanged files are answered from cache
+	const bool cacheable = success && opts.cache != nullptr && S_ISREG(info.st_mode) && !opts.decompress && opts.merkle_leaf == 0u;
+	const auto identity = file_identity::of(info);
+
+	std::vector<std::optional<digest>> cached(selected.size());
+
+	if (cacheable) {
+		for (size_t i = 0; i != selected.size(); ++i) {
+			cached[i] = opts.cache->find(identity, selected[i]->name);
+		}
+
+		if (std::all_of(cached.begin(), cached.end(), [](const auto & d) { return d.has_value(); })) {
+			if (!is_stdin) {
+				close(fd);
+			}
+
+			std::vector<digest> output;
+			for (const auto & d: cached) {
+				output.push_back(*d);
+			}
+			return output;
+		}
+	}
+
+	// only algorithms missing in cache are computed (decompressing hasher has its own)
+	for (size_t i = 0; i != selected.size() && !decompressing; ++i) {
+		if (!cached[i]) {
+			hashers.push_back(opts.merkle_leaf != 0u ? selected[i]->create_merkle(opts.merkle_leaf) : selected[i]->create());
+		}
+	}
+
+	// non-seekable inputs fail here with ESPIPE
+	const bool seekable = success && lseek(fd, 0, SEEK_CUR) == 0;
+
+	if (success) {
+		if (seekable && S_ISREG(info.st_mode) && opts.merkle_leaf != 0u) {
+			// holes of sparse files are not read
+			success = read_sparse(fd, static_cast<uint64_t>(info.st_size), update, [&](uint64_t length) {
+				for (const auto & h: hashers) {
+					h->update_zeros(length);
+				}
+			});
+		} else if (seekable && should_stream(info, opts)) {
+			// block devices report zero size in stat
+			const off_t size = lseek(fd, 0, SEEK_END);
+			success = size >= 0 && stream_file(fd, static_cast<uint64_t>(size), opts.stream, update);
+		} else if (seekable && S_ISREG(info.st_mode)) {
+			success = map_file(fd, static_cast<uint64_t>(info.st_size), opts.map, update);
+		} else {
+			// pipes, character devices and sockets can't be mapped or read in parallel
+			success = read_stream(fd, update);
+		}
+	}
+
+	if (!is_stdin) {
+		close(fd);
+	}
+
+	if (!success) {
+		return std::nullopt;
+	}
+
+	// compressed and decompressed digest
+	if (decompressing) {
+		const auto r = decompressing->final();
+
+		if (!decoded || !r) {
+			return std::nullopt;
+		}
+
+		return std::vector<digest>{r->compressed, r->decompressed};
+	}
+
+	std::vector<digest> output;
+	auto hasher = hashers.begin();
+
+	for (size_t i = 0; i != selected.size(); ++i) {
+		if (cached[i]) {
+			output.push_back(*cached[i]);
+			continue;
+		}
+
+		output.push_back((*hasher++)->final());
+
+		if (cacheable) {
+			opts.cache->insert(identity, selected[i]->name, output.back());
+		}
+	}
+	return output;
+}
+
+// set of inputs hashed by one worker, small files are grouped so they are loaded and hashed together
+struct hash_job {
+	size_t first; // into `members`
+	size_t count;
+	bool batch;
+};
+
+// hash all inputs in parallel, `selected_of(i)` gives algorithms for input `i` and `done(i, result)`
+// is called from worker threads (after `cancel` is set remaining inputs are reported as failed)
+template <typename Selected, typename Done> void hash_inputs(std::span<const std::string> paths, std::span<const input_info> infos, const options & opts, Selected && selected_of, Done && done, const std::atomic<bool> * cancel = nullptr) {
+	// cache needs identity of each file, which is what batching avoids
+	const bool batching = opts.cache == nullptr && !opts.force_stream && !opts.decompress && opts.merkle_leaf == 0u;
+
+	std::vector<size_t> members;
+	std::vector<hash_job> jobs;
+	std::vector<task> tasks;
+	std::vector<size_t> small;
+
+	for (size_t i = 0; i != paths.size(); ++i) {
+		if (batching && infos[i].regular && infos[i].size <= opts.small.max_size) {
+			small.push_back(i);
+		} else {
+			tasks.push_back(task{jobs.size(), infos[i].size});
+			jobs.push_back(hash_job{members.size(), 1u, false});
+			members.push_back(i);
+		}
+	}
+
+	// only inputs with same algorithms can be in one batch
+	const auto same_algorithms = [&](size_t lhs, size_t rhs) {
+		const auto a = selected_of(lhs);
+		const auto b = selected_of(rhs);
+		return std::equal(a.begin(), a.end(), b.begin(), b.end());
+	};
+
+	std::stable_sort(small.begin(), small.end(), [&](size_t lhs, size_t rhs) {
+		const auto a = selected_of(lhs);
+		const auto b = selected_of(rhs);
+		return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), std::less<>{});
+	});
+
+	for (size_t i = 0; i != small.size();) {
+		size_t count = 1u;
+		uint64_t cost = infos[small[i]].size;
+
+		while (i + count != small.size() && count != opts.small.batch && same_algorithms(small[i], small[i + count])) {
+			cost += infos[small[i + count]].size;
+			++count;
+		}
+
+		// each file costs few syscalls, which is comparable with hashing of few kilobytes
+		tasks.push_back(task{jobs.size(), cost + count * 4096u});
+		jobs.push_back(hash_job{members.size(), count, true});
+		members.insert(members.end(), small.begin() + static_cast<std::ptrdiff_t>(i), small.begin() + static_cast<std::ptrdiff_t>(i + count));
+		i += count;
+	}
+
+	const auto cancelled = [cancel] { return cancel != nullptr && cancel->load(); };
+
+	auto pool = work_stealing_pool(std::move(tasks), static_cast<unsigned>(std::min<size_t>(opts.jobs, std::max<size_t>(jobs.size(), 1u))));
+
+	pool.run([&](task t) {
+		const hash_job & job = jobs[t.index];
+		const auto items = std::span<const size_t>(members).subspan(job.first, job.count);
+
+		if (!job.batch) {
+			done(items[0], cancelled() ? std::nullopt : hash_input(paths[items[0]], selected_of(items[0]), opts));
+			return;
+		}
+
+		thread_local auto loader = std::optional<small_file_loader>{};
+		if (!loader) {
+			loader.emplace(opts.small);
+		}
+
+		std::vector<std::string> names;
+		std::vector<uint64_t> sizes;
+		names.reserve(items.size());
+		sizes.reserve(items.size());
+		for (size_t i: items) {
+			names.push_back(paths[i]);
+			sizes.push_back(infos[i].size);
+		}
+
+		const auto contents = loader->load(names, sizes);
+
+		std::vector<size_t> loaded;
+		std::vector<std::span<const std::byte>> inputs;
+		for (size_t i = 0; i != contents.size(); ++i) {
+			if (contents[i]) {
+				loaded.push_back(i);
+				inputs.push_back(*contents[i]);
+			}
+		}
+
+		// all loaded files are hashed together in lanes, one algorithm after another
+		const auto selected = selected_of(items[0]);
+		std::vector<std::vector<digest>> results(items.size());
+		std::vector<digest> digests(inputs.size());
+
+		for (const algorithm * a: selected) {
+			a->hash_many(inputs, digests);
+			for (size_t k = 0; k != loaded.size(); ++k) {
+				results[loaded[k]].push_back(digests[k]);
+			}
+		}
+
+		for (size_t i = 0; i != items.size(); ++i) {
+			if (contents[i]) {
+				done(items[i], std::optional(std::move(results[i])));
+			} else {
+				// unreadable or changed file is processed normally (so errors are reported same way)
+				done(items[i], cancelled() ? std::nullopt : hash_input(paths[items[i]], selected_of(items[i]), opts));
+			}
+		}
+	});
+}
+
+// read whole manifest, files are mapped, standard input is copied
+auto load_manifest(std::string_view path, const algorithm * forced) -> std::optional<manifest> {
+	if (path == "-") {
+		std::vector<std::byte> content;
+		if (!read_stream(STDIN_FILENO, [&](std::span<const std::byte> chunk) { content.insert(content.end(), chunk.begin(), chunk.end()); })) {
+			return std::nullopt;
+		}
+		return parse_manifest(content, forced);
+	}
+
+	const auto f = mapped_file(std::string(path).c_str());
+
+	if (!f.valid()) {
+		return std::nullopt;
+	}
+
+	return parse_manifest(f.get_span(), forced);
+}
+
+// verify all entries of manifests, output is in same format as GNU tools
+int check_manifests(const options & opts) {
+	const algorithm * forced = opts.selected.empty() ? nullptr : opts.selected.front();
+
+	std::vector<manifest_entry> entries;
+	size_t malformed = 0;
+
+	for (const auto path: opts.paths) {
+		auto m = load_manifest(path, forced);
+
+		if (!m) {
+			std::cerr << "can't read manifest '" << path << "'!\n";
+			return 1;
+		}
+
+		if (m->malformed != 0u) {
+			std::cerr << path << ": " << m->malformed << " line(s) are improperly formatted\n";
+		}
+
+		malformed += m->malformed;
+		std::move(m->entries.begin(), m->entries.end(), std::back_inserter(entries));
 	}
 
 	const auto start = std::chrono::high_resolution_clock::now();
 
-	if (h == "sha-224") {
-		std::cout << cthash::sha224{}.update(f.get_span()).final() << "\n";
-	} else if (h == "sha-256") {
-		std::cout << cthash::sha256{}.update(f.get_span()).final() << "\n";
-	} else if (h == "sha-384") {
-		std::cout << cthash::sha384{}.update(f.get_span()).final() << "\n";
-	} else if (h == "sha-512") {
-		std::cout << cthash::sha512{}.update(f.get_span()).final() << "\n";
-	} else if (h == "sha-512/224") {
-		std::cout << cthash::sha512t<224>{}.update(f.get_span()).final() << "\n";
-	} else if (h == "sha-512/256") {
-		std::cout << cthash::sha512t<256>{}.update(f.get_span()).final() << "\n";
-	} else if (h == "sha3-224") {
-		std::cout << cthash::sha3_224{}.update(f.get_span()).final() << "\n";
-	} else if (h == "sha3-256") {
-		std::cout << cthash::sha3_256{}.update(f.get_span()).final() << "\n";
-	} else if (h == "sha3-384") {
-		std::cout << cthash::sha3_384{}.update(f.get_span()).final() << "\n";
-	} else if (h == "sha3-512") {
-		std::cout << cthash::sha3_512{}.update(f.get_span()).final() << "\n";
-	} else if (h == "shake-128/32") {
-		std::cout << cthash::shake128{}.update(f.get_span()).final<32>() << "\n";
-	} else if (h == "shake-128/64") {
-		std::cout << cthash::shake128{}.update(f.get_span()).final<64>() << "\n";
-	} else if (h == "shake-128/128") {
-		std::cout << cthash::shake128{}.update(f.get_span()).final<128>() << "\n";
-	} else if (h == "shake-128/256") {
-		std::cout << cthash::shake128{}.update(f.get_span()).final<256>() << "\n";
-	} else if (h == "shake-128/512") {
-		std::cout << cthash::shake128{}.update(f.get_span()).final<512>() << "\n";
-	} else if (h == "shake-128/1024") {
-		std::cout << cthash::shake128{}.update(f.get_span()).final<1024>() << "\n";
-	} else if (h == "shake-128/2048") {
-		std::cout << cthash::shake128{}.update(f.get_span()).final<2048>() << "\n";
-	} else if (h == "shake-256/32") {
-		std::cout << cthash::shake256{}.update(f.get_span()).final<32>() << "\n";
-	} else if (h == "shake-256/64") {
-		std::cout << cthash::shake256{}.update(f.get_span()).final<64>() << "\n";
-	} else if (h == "shake-256/128") {
-		std::cout << cthash::shake256{}.update(f.get_span()).final<128>() << "\n";
-	} else if (h == "shake-256/256") {
-		std::cout << cthash::shake256{}.update(f.get_span()).final<256>() << "\n";
-	} else if (h == "shake-256/512") {
-		std::cout << cthash::shake256{}.update(f.get_span()).final<512>() << "\n";
-	} else if (h == "shake-256/1024") {
-		std::cout << cthash::shake256{}.update(f.get_span()).final<1024>() << "\n";
-	} else if (h == "shake-256/2048") {
-		std::cout << cthash::shake256{}.update(f.get_span()).final<2048>() << "\n";
-	} else {
-		std::cerr << "unknown hash function!\n";
-		return 1;
+	std::vector<std::string> paths;
+	std::vector<input_info> infos;
+	paths.reserve(entries.size());
+	infos.reserve(entries.size());
+
+	for (const auto & entry: entries) {
+		paths.push_back(entry.path);
+		infos.push_back(probe_input(entry.path));
+	}
+
+	auto output = reorder_buffer(entries.size(), std::cout);
+
+	std::atomic<bool> stop{false};
+	std::atomic<size_t> mismatched{0};
+	std::atomic<size_t> unreadable{0};
+	std::atomic<size_t> verified{0};
+	std::atomic<uint64_t> verified_bytes{0};
+
+	const auto selected_of = [&](size_t i) { return std::span<const algorithm * const>(&entries[i].algo, 1u); };
+
+	hash_inputs(paths, infos, opts, selected_of, [&](size_t index, const std::optional<std::vector<digest>> & result) {
+		// with --fail-fast remaining entries are skipped, but still must be marked as complete
+		if (stop) {
+			output.complete(index, {});
+			return;
+		}
+
+		const auto & entry = entries[index];
+		std::string line = entry.path;
+
+		if (!result) {
+			line += ": FAILED open or read\n";
+			++unreadable;
+			stop = opts.fail_fast;
+		} else if (const auto computed = result->front().view(), expected = entry.expected.view(); !std::equal(computed.begin(), computed.end(), expected.begin(), expected.end())) {
+			line += ": FAILED\n";
+			++mismatched;
+			stop = opts.fail_fast;
+		} else {
+			line += ": OK\n";
+			++verified;
+			verified_bytes += infos[index].regular ? infos[index].size : 0u;
+		}
+
+		output.complete(index, std::move(line));
+	}, &stop);
+
+	const auto end = std::chrono::high_resolution_clock::now();
+	const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+	const double mib = static_cast<double>(verified_bytes.load()) / (1024.0 * 1024.0);
+
+	if (mismatched != 0u) {
+		std::cerr << "WARNING: " << mismatched << " computed checksum(s) did NOT match\n";
+	}
+
+	if (unreadable != 0u) {
+		std::cerr << "WARNING: " << unreadable << " listed file(s) could not be read\n";
+	}
+
+	std::cerr << "verified " << verified << " file(s), " << mib << " MiB in " << ms << " ms";
+	if (ms != 0) {
+		std::cerr << " (" << (mib * 1000.0 / static_cast<double>(ms)) << " MiB/s)";
+	}
+	std::cerr << "\n";
+
+	return (mismatched != 0u || unreadable != 0u || malformed != 0u || entries.empty()) ? 1 : 0;
+}
+
+// changed files are rehashed (and printed) after they are quiet for a while, cache is opened only for that time
+void watch_tree(const options & opts, const std::string & root, const tree_listing & listing) {
+	auto watch = tree_watch(root);
+
+	if (!watch.valid() || !watch.add(std::string{})) {
+		std::cerr << "can't watch '" << root << "'!\n";
+		return;
+	}
+
+	for (const auto & dir: listing.directories) {
+		watch.add(dir);
+	}
+
+	std::cerr << "watching " << watch.directories.size() << " directories\n";
+
+	watch.run(opts.jobs, [&](const std::string & path) {
+		auto local = opts;
+		auto cache = digest_cache(std::string(opts.cache_path));
+		local.cache = cache.valid() ? &cache : nullptr;
+
+		if (auto result = hash_input(watch.full_path(path), std::span(&opts.selected.front(), 1u), local)) {
+			std::cout << manifest_line(result->front(), path) << std::flush;
+		}
+	});
+}
+
+// sorted manifest of all regular files in the tree (paths relative to the root) and root digest over it
+int hash_tree(const options & opts) {
+	const algorithm * algo = opts.selected.front();
+	auto walker = tree_walker(std::string(opts.paths.front()));
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	const auto listing = walker.run(opts.jobs);
+
+	// in watch mode cache is not opened by caller
+	auto cached_opts = opts;
+	auto cache = (opts.watch) ? std::make_unique<digest_cache>(std::string(opts.cache_path)) : nullptr;
+
+	if (cache && cache->valid()) {
+		cached_opts.cache = cache.get();
+	}
+
+	for (const auto & path: listing.errors) {
+		std::cerr << "can't read '" << path << "'!\n";
+	}
+
+	std::vector<std::string> paths;
+	std::vector<input_info> infos;
+	paths.reserve(listing.files.size());
+	infos.reserve(listing.files.size());
+
+	for (const auto & file: listing.files) {
+		paths.push_back(walker.full_path(file.path));
+		infos.push_back(input_info{file.size, true});
+	}
+
+	std::vector<std::optional<digest>> digests(listing.files.size());
+	std::atomic<bool> failed{!listing.errors.empty()};
+
+	const auto selected_of = [&](size_t) { return std::span<const algorithm * const>(&algo, 1u); };
+
+	hash_inputs(paths, infos, cached_opts, selected_of, [&](size_t index, const std::optional<std::vector<digest>> & result) {
+		if (result) {
+			digests[index] = result->front();
+		} else {
+			failed = true;
+		}
+	});
+
+	// canonical manifest is exactly the printed text
+	const auto root = algo->create();
+
+	for (size_t i = 0; i != listing.files.size(); ++i) {
+		if (!digests[i]) {
+			std::cerr << "can't read '" << walker.full_path(listing.files[i].path) << "'!\n";
+			continue;
+		}
+
+		const auto line = manifest_line(*digests[i], listing.files[i].path);
+		root->update(std::as_bytes(std::span(line.data(), line.size())));
+		std::cout << line;
+	}
+
+	std::cout << "# root " << algo->name << " = " << root->final() << std::endl;
+
+	if (listing.skipped != 0u) {
+		std::cerr << listing.skipped << " non-regular file(s) skipped\n";
 	}
 
+	const auto end = std::chrono::high_resolution_clock::now();
+	std::cerr << "and it took " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms\n";
+
+	cache.reset();
+
+	if (opts.watch) {
+		watch_tree(opts, walker.root, listing);
+	}
+
+	return failed ? 1 : 0;
+}
+
+// changes between two manifests (output similar to `git diff --name-status`)
+int compare_manifests(const options & opts) {
+	const algorithm * forced = opts.selected.empty() ? nullptr : opts.selected.front();
+
+	auto lhs = load_manifest(opts.paths[0], forced);
+	auto rhs = load_manifest(opts.paths[1], forced);
+
+	if (!lhs || !rhs) {
+		std::cerr << "can't read manifest '" << (lhs ? opts.paths[1] : opts.paths[0]) << "'!\n";
+		return 2;
+	}
+
+	const size_t changes = diff_manifests(std::move(lhs->entries), std::move(rhs->entries), [](tree_change change, std::string_view path) {
+		constexpr char marks[] = {'A', 'D', 'M'};
+		std::cout << marks[static_cast<int>(change)] << '\t' << path << '\n';
+	});
+
+	return (changes != 0u) ? 1 : 0;
+}
+
+// hash each file with all selected algorithms
+int hash_files(const options & opts) {
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	// single file with single hash prints only digest
+	const bool digest_only = !opts.tagged && opts.paths.size() == 1u && opts.selected.size() == 1u;
+
+	std::vector<std::string> paths;
+	std::vector<input_info> infos;
+	paths.reserve(opts.paths.size());
+	infos.reserve(opts.paths.size());
+
+	for (const auto path: opts.paths) {
+		paths.emplace_back(path);
+		infos.push_back(probe_input(path));
+	}
+
+	auto output = reorder_buffer(opts.paths.size(), std::cout);
+	std::atomic<bool> failed{false};
+
+	const auto selected_of = [&](size_t) { return std::span<const algorithm * const>(opts.selected); };
+
+	hash_inputs(paths, infos, opts, selected_of, [&](size_t index, const std::optional<std::vector<digest>> & result) {
+		const auto path = opts.paths[index];
+
+		std::ostringstream line;
+
+		if (!result) {
+			std::cerr << (opts.decompress ? "can't read or decompress '" : "can't read '") << path << "'!\n";
+			failed = true;
+		} else if (opts.decompress) {
+			// decompressed digest is a comment, so output can be still verified with -c
+			if (opts.tagged) {
+				line << opts.selected[0]->name << " (" << path << ") = " << (*result)[0] << "\n";
+				line << "# decompressed " << opts.selected[0]->name << " (" << path << ") = " << (*result)[1] << "\n";
+			} else {
+				line << (*result)[0] << "  " << path << "\n";
+				line << "# decompressed " << (*result)[1] << "  " << path << "\n";
+			}
+		} else if (digest_only) {
+			line << result->front() << "\n";
+		} else if (opts.tagged) {
+			for (size_t i = 0; i != result->size(); ++i) {
+				line << opts.selected[i]->name << " (" << path << ") = " << (*result)[i] << "\n";
+			}
+		} else {
+			for (const auto & d: *result) {
+				line << d << "  " << path << "\n";
+			}
+		}
+
+		output.complete(index, std::move(line).str());
+	});
+
 	const auto end = std::chrono::high_resolution_clock::now();
 	const auto dur = end - start;
 
 	std::cerr << "and it took " << std::chrono::duration_cast<std::chrono::milliseconds>(dur).count() << " ms\n";
-}
\ No newline at end of file
+
+	return failed ? 1 : 0;
+}
+
+// manifest of regular members of an archive and digest of the whole archive, computed in one pass: each
+// tile of input is hashed into the archive digest and then (while it's still in cache) into the member
+int hash_archive(const options & opts) {
+	const algorithm * algo = opts.selected.front();
+	const auto path = opts.paths.front();
+
+	const bool is_stdin = (path == "-");
+	const int fd = is_stdin ? STDIN_FILENO : open(std::string(path).c_str(), O_RDONLY | O_CLOEXEC);
+
+	if (fd == -1) {
+		std::cerr << "can't open '" << path << "'!\n";
+		return 2;
+	}
+
+	auto archive = algo->create();
+	std::unique_ptr<any_hasher> member;
+	size_t members = 0;
+	size_t skipped = 0;
+
+	auto parser = tar_parser{
+		[&](const tar_member & m) {
+			if (m.regular()) {
+				member = algo->create();
+			}
+		},
+		[&](std::span<const std::byte> payload) { member->update(payload); },
+		[&](const tar_member & m) {
+			if (!m.regular()) {
+				skipped += (m.type != '5');
+				return;
+			}
+			std::cout << manifest_line(member->final(), m.path);
+			member.reset();
+			++members;
+		}};
+
+	const auto update = [&](std::span<const std::byte> chunk) {
+		while (!chunk.empty()) {
+			const auto tile = chunk.first(std::min(chunk.size(), cthash::multi_hasher_tile_size));
+			archive->update(tile);
+			parser.feed(tile);
+			chunk = chunk.subspan(tile.size());
+		}
+	};
+
+	struct stat info {};
+	const bool success = (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && lseek(fd, 0, SEEK_CUR) == 0) ? map_file(fd, static_cast<uint64_t>(info.st_size), opts.map, update) : read_stream(fd, update);
+
+	if (!is_stdin) {
+		close(fd);
+	}
+
+	if (!success) {
+		std::cerr << "can't read '" << path << "'!\n";
+		return 2;
+	}
+
+	if (parser.failed() || !parser.complete()) {
+		std::cerr << "'" << path << "' is not a valid tar archive (or it's truncated)!\n";
+		return 1;
+	}
+
+	std::cout << "# archive " << algo->name << " = " << archive->final() << std::endl;
+
+	if (skipped != 0u) {
+		std::cerr << skipped << " non-regular member(s) skipped\n";
+	}
+
+	std::cerr << members << " member(s) hashed\n";
+	return 0;
+}
+
+// forward standard input into standard output and hash it on the way
+int tee_input(const options & opts) {
+	std::vector<std::unique_ptr<any_hasher>> hashers;
+	for (const algorithm * a: opts.selected) {
+		hashers.push_back(a->create());
+	}
+
+	const bool success = tee_stream(STDIN_FILENO, STDOUT_FILENO, [&](std::span<const std::byte> chunk) { update_in_tiles(chunk, hashers); });
+
+	if (!success) {
+		std::cerr << "can't copy standard input into standard output!\n";
+		return 1;
+	}
+
+	std::ostringstream lines;
+	for (size_t i = 0; i != hashers.size(); ++i) {
+		lines << opts.selected[i]->name << " (-) = " << hashers[i]->final() << "\n";
+	}
+
+	if (opts.digest_path.empty()) {
+		std::cerr << lines.str();
+		return 0;
+	}
+
+	auto file = std::ofstream(std::string(opts.digest_path));
+	file << lines.str();
+
+	if (!file.flush()) {
+		std::cerr << "can't write digest into '" << opts.digest_path << "'!\n";
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char ** argv) {
+	auto opts = parse_options(argc, argv);
+
+	if (!opts) {
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	if (opts->bench) {
+		const auto settings = bench_options{.json = opts->json};
+		const auto bandwidth = measure_bandwidth(settings);
+		const auto results = run_bench(opts->selected, settings);
+		print_bench(std::cout, results, bandwidth, settings.json);
+		return 0;
+	}
+
+	if (opts->diff) {
+		return compare_manifests(*opts);
+	}
+
+	if (opts->tee) {
+		return tee_input(*opts);
+	}
+
+	if (opts->tar) {
+		return hash_archive(*opts);
+	}
+
+	// watch mode opens cache only when it's needed so other processes are not blocked
+	std::unique_ptr<digest_cache> cache;
+
+	if (!opts->cache_path.empty() && !opts->watch) {
+		cache = std::make_unique<digest_cache>(std::string(opts->cache_path));
+
+		if (cache->valid()) {
+			opts->cache = cache.get();
+		} else {
+			std::cerr << "can't open cache '" << opts->cache_path << "', continuing without it\n";
+		}
+	}
+
+	const int result = opts->check ? check_manifests(*opts) : (opts->recursive ? hash_tree(*opts) : hash_files(*opts));
+
+	if (opts->cache != nullptr) {
+		std::cerr << "cache: " << opts->cache->hits << " hit(s), " << opts->cache->misses << " miss(es)\n";
+	}
+
+	return result;
+}
@@ -0,0 +1,220 @@
+#ifndef CTHASH_SHASUM_ALGORITHMS_HPP
+#define CTHASH_SHASUM_ALGORITHMS_HPP
+
+#include <cthash/cthash.hpp>
+#include <cthash/merkle.hpp>
+#include <cthash/multi_hasher.hpp>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <string_view>
+#include <vector>
+#include <iostream>
+
+// digest of any supported algorithm (longest is shake with 2048 bits)
+struct digest {
+	std::array<std::byte, 256> bytes{};
+	size_t length{0};
+
+	auto view() const noexcept {
+		return std::span<const std::byte>(bytes).first(length);
+	}
+
+	template <typename CharT, typename Traits> friend auto & operator<<(std::basic_ostream<CharT, Traits> & os, const digest & d) {
+		std::array<CharT, 2u * std::tuple_size_v<decltype(digest::bytes)>> buffer;
+		cthash::internal::encode_hexdec(d.view(), buffer.data());
+		return os.write(buffer.data(), static_cast<std::streamsize>(2u * d.length));
+	}
+};
+
+// hasher with algorithm selected at runtime
+struct any_hasher {
+	virtual ~any_hasher() = default;
+	virtual void update(std::span<const std::byte> in) = 0;
+	virtual digest final() = 0;
+
+	// zeros of sparse file (merkle hashers don't need to hash them)
+	virtual void update_zeros(uint64_t length) {
+		constexpr std::array<std::byte, 4096> zeros{};
+
+		while (length != 0u) {
+			const size_t n = static_cast<size_t>(std::min<uint64_t>(length, zeros.size()));
+			update(std::span(zeros).first(n));
+			length -= n;
+		}
+	}
+};
+
+template <typename Hasher, size_t Bits> struct any_hasher_impl final: any_hasher {
+	Hasher hasher{};
+
+	void update(std::span<const std::byte> in) override {
+		hasher.update(in);
+	}
+
+	digest final() override {
+		const auto r = [&] {
+			if constexpr (Bits == 0u) {
+				return hasher.final();
+			} else {
+				return hasher.template final<Bits>();
+			}
+		}();
+
+		digest output;
+		std::copy(r.begin(), r.end(), output.bytes.begin());
+		output.length = r.size();
+		return output;
+	}
+};
+
+template <typename Hasher> struct any_merkle_hasher final: any_hasher {
+	cthash::merkle_hasher<Hasher> hasher;
+
+	explicit any_merkle_hasher(const cthash::merkle_zero_subtrees<Hasher> & zeros): hasher{zeros} { }
+
+	void update(std::span<const std::byte> in) override {
+		hasher.update(in);
+	}
+
+	void update_zeros(uint64_t length) override {
+		hasher.update_zeros(length);
+	}
+
+	digest final() override {
+		const auto r = hasher.final();
+
+		digest output;
+		std::copy(r.begin(), r.end(), output.bytes.begin());
+		output.length = r.size();
+		return output;
+	}
+};
+
+struct algorithm {
+	std::string_view name;
+	std::unique_ptr<any_hasher> (*create)();
+	void (*hash_many)(std::span<const std::span<const std::byte>> in, std::span<digest> out); // hashed together in lanes
+	std::unique_ptr<any_hasher> (*create_merkle)(size_t leaf_size);								// nullptr for variable length digests
+};
+
+template <typename Hasher, size_t Bits = 0u> auto make_hasher() -> std::unique_ptr<any_hasher> {
+	return std::make_unique<any_hasher_impl<Hasher, Bits>>();
+}
+
+// zero subtrees are computed once for each leaf size and shared by hashers of all files
+template <typename Hasher> auto make_merkle_hasher(size_t leaf_size) -> std::unique_ptr<any_hasher> {
+	using zeros_t = cthash::merkle_zero_subtrees<Hasher>;
+
+	static std::mutex lock;
+	static std::vector<std::unique_ptr<const zeros_t>> tables;
+
+	const auto guard = std::lock_guard{lock};
+	auto it = std::find_if(tables.begin(), tables.end(), [&](const auto & t) { return t->leaf_size == leaf_size; });
+
+	if (it == tables.end()) {
+		it = tables.insert(tables.end(), std::make_unique<const zeros_t>(leaf_size));
+	}
+
+	return std::make_unique<any_merkle_hasher<Hasher>>(**it);
+}
+
+template <typename Hasher, size_t Bits = 0u> void hash_many_with(std::span<const std::span<const std::byte>> in, std::span<digest> out) {
+	using result_t = std::conditional_t<Bits == 0u, typename Hasher::result_t, std::array<std::byte, Bits / 8u>>;
+
+	std::vector<result_t> results(in.size());
+
+	if constexpr (Bits == 0u) {
+		cthash::hash_many<Hasher>(in, std::span(results));
+	} else {
+		cthash::hash_many<Hasher>(in, std::span<result_t>(results));
+	}
+
+	for (size_t i = 0; i != results.size(); ++i) {
+		std::copy(results[i].begin(), results[i].end(), out[i].bytes.begin());
+		out[i].length = results[i].size();
+	}
+}
+
+template <typename Hasher, size_t Bits = 0u> constexpr auto make_algorithm(std::string_view name) -> algorithm {
+	if constexpr (Bits == 0u) {
+		return algorithm{name, make_hasher<Hasher, Bits>, hash_many_with<Hasher, Bits>, make_merkle_hasher<Hasher>};
+	} else {
+		return algorithm{name, make_hasher<Hasher, Bits>, hash_many_with<Hasher, Bits>, nullptr};
+	}
+}
+
+constexpr auto algorithms = std::array{
+	make_algorithm<cthash::sha224>("sha-224"),
+	make_algorithm<cthash::sha256>("sha-256"),
+	make_algorithm<cthash::sha384>("sha-384"),
+	make_algorithm<cthash::sha512>("sha-512"),
+	make_algorithm<cthash::sha512t<224>>("sha-512/224"),
+	make_algorithm<cthash::sha512t<256>>("sha-512/256"),
+	make_algorithm<cthash::sha3_224>("sha3-224"),
+	make_algorithm<cthash::sha3_256>("sha3-256"),
+	make_algorithm<cthash::sha3_384>("sha3-384"),
+	make_algorithm<cthash::sha3_512>("sha3-512"),
+	make_algorithm<cthash::shake128, 32>("shake-128/32"),
+	make_algorithm<cthash::shake128, 64>("shake-128/64"),
+	make_algorithm<cthash::shake128, 128>("shake-128/128"),
+	make_algorithm<cthash::shake128, 256>("shake-128/256"),
+	make_algorithm<cthash::shake128, 512>("shake-128/512"),
+	make_algorithm<cthash::shake128, 1024>("shake-128/1024"),
+	make_algorithm<cthash::shake128, 2048>("shake-128/2048"),
+	make_algorithm<cthash::shake256, 32>("shake-256/32"),
+	make_algorithm<cthash::shake256, 64>("shake-256/64"),
+	make_algorithm<cthash::shake256, 128>("shake-256/128"),
+	make_algorithm<cthash::shake256, 256>("shake-256/256"),
+	make_algorithm<cthash::shake256, 512>("shake-256/512"),
+	make_algorithm<cthash::shake256, 1024>("shake-256/1024"),
+	make_algorithm<cthash::shake256, 2048>("shake-256/2048"),
+};
+
+inline auto find_algorithm(std::string_view name) -> const algorithm * {
+	for (const auto & a: algorithms) {
+		if (a.name == name) {
+			return &a;
+		}
+	}
+	return nullptr;
+}
+
+// parse comma separated list of algorithms
+inline auto parse_algorithms(std::string_view list) -> std::optional<std::vector<const algorithm *>> {
+	std::vector<const algorithm *> output;
+
+	while (!list.empty()) {
+		const auto comma = list.find(',');
+		const auto name = list.substr(0, comma);
+
+		const algorithm * a = find_algorithm(name);
+		if (a == nullptr) {
+			std::cerr << "unknown hash function '" << name << "'!\n";
+			return std::nullopt;
+		}
+
+		output.push_back(a);
+		list = (comma == std::string_view::npos) ? std::string_view{} : list.substr(comma + 1u);
+	}
+
+	return output;
+}
+
+// walk input once, every tile is given to all hashers while it's in cache
+inline void update_in_tiles(std::span<const std::byte> in, std::span<const std::unique_ptr<any_hasher>> hashers) {
+	while (!in.empty()) {
+		const auto tile = in.first(std::min(in.size(), cthash::multi_hasher_tile_size));
+
+		for (const auto & h: hashers) {
+			h->update(tile);
+		}
+
+		in = in.subspan(tile.size());
+	}
+}
+
+#endif
@@ -0,0 +1,254 @@
+#ifndef CTHASH_SHASUM_BENCH_HPP
+#define CTHASH_SHASUM_BENCH_HPP
+
+#include "algorithms.hpp"
+#include "input.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// throughput measurement of all hash functions, so hardware can be qualified without test-runner
+
+struct bench_options {
+	std::chrono::milliseconds duration{200};		 // minimal time of each measurement
+	std::vector<size_t> sizes{64u, 1024u, 64u * 1024u, 1024u * 1024u};
+	size_t file_size{64u * 1024u * 1024u};	 // 0 to skip measurement of file input
+	size_t bandwidth_size{256u * 1024u * 1024u};
+	bool json{false};
+};
+
+struct bench_result {
+	std::string_view algorithm;
+	std::string input; // size of buffer or "file"
+	uint64_t bytes{0};
+	double seconds{0.0};
+	double ticks{0.0}; // of time stamp counter (constant rate, not core cycles), zero when not available
+
+	double gbps() const noexcept {
+		return static_cast<double>(bytes) / seconds / 1e9;
+	}
+
+	double ticks_per_byte() const noexcept {
+		return ticks / static_cast<double>(bytes);
+	}
+};
+
+inline bool have_tick_counter() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+	return true;
+#else
+	return false;
+#endif
+}
+
+inline uint64_t read_tick_counter() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0u;
+#endif
+}
+
+// there is only portable implementation of single stream hashing, lanes are used only by batch APIs
+inline std::string bench_backend() {
+	std::string r = "portable C++";
+
+#if defined(__x86_64__)
+	r += ", x86-64";
+#elif defined(__aarch64__)
+	r += ", aarch64";
+#endif
+
+#if defined(__AVX512F__)
+	r += " avx512f";
+#elif defined(__AVX2__)
+	r += " avx2";
+#endif
+
+	return r;
+}
+
+// measure `fn(bytes)` repeatedly until duration is reached
+template <typename Fn> bench_result measure(std::string_view name, std::string input, std::chrono::milliseconds duration, Fn && fn) {
+	using clock = std::chrono::steady_clock;
+
+	bench_result r{name, std::move(input)};
+
+	const auto start = clock::now();
+	const uint64_t start_ticks = read_tick_counter();
+
+	do {
+		r.bytes += fn();
+	} while (clock::now() - start < duration);
+
+	const uint64_t end_ticks = read_tick_counter();
+	r.seconds = std::chrono::duration<double>(clock::now() - start).count();
+	r.ticks = static_cast<double>(end_ticks - start_ticks);
+	return r;
+}
+
+// sequential read from memory as upper bound for hashing of data not in cache
+inline bench_result measure_bandwidth(const bench_options & opts) {
+	std::vector<uint64_t> buffer(opts.bandwidth_size / sizeof(uint64_t));
+	std::iota(buffer.begin(), buffer.end(), uint64_t{0});
+
+	volatile uint64_t sink = 0;
+
+	auto r = measure("memory read", std::to_string(opts.bandwidth_size), opts.duration, [&] {
+		uint64_t sum = 0;
+		for (uint64_t v: buffer) {
+			sum += v;
+		}
+		sink = sink + sum;
+		return buffer.size() * sizeof(uint64_t);
+	});
+
+	return r;
+}
+
+// temporary file which is dropped from page cache before each pass
+struct bench_file {
+	std::string path;
+	int fd{-1};
+	uint64_t size{0};
+
+	explicit bench_file(size_t sz) {
+		const char * tmp = std::getenv("TMPDIR");
+		path = std::string(tmp != nullptr ? tmp : "/tmp") + "/shasum-bench-XXXXXX";
+		fd = mkstemp(path.data());
+
+		if (fd == -1) {
+			return;
+		}
+
+		unlink(path.c_str());
+
+		std::vector<std::byte> chunk(1024u * 1024u);
+		for (size_t i = 0; i != chunk.size(); ++i) {
+			chunk[i] = static_cast<std::byte>(i * 131u + 7u);
+		}
+
+		while (size < sz) {
+			const size_t n = std::min(chunk.size(), sz - static_cast<size_t>(size));
+			if (write(fd, chunk.data(), n) != static_cast<ssize_t>(n)) {
+				close(fd);
+				fd = -1;
+				return;
+			}
+			size += n;
+		}
+
+		fdatasync(fd);
+	}
+
+	bench_file(const bench_file &) = delete;
+	bench_file(bench_file &&) = delete;
+
+	~bench_file() {
+		if (fd != -1) {
+			close(fd);
+		}
+	}
+
+	bool valid() const noexcept {
+		return fd != -1;
+	}
+
+	void drop_cache() const {
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	}
+};
+
+inline auto run_bench(std::span<const algorithm * const> selected, const bench_options & opts) -> std::vector<bench_result> {
+	std::vector<bench_result> results;
+
+	size_t largest = 0;
+	for (size_t sz: opts.sizes) {
+		largest = std::max(largest, sz);
+	}
+
+	std::vector<std::byte> buffer(largest);
+	for (size_t i = 0; i != buffer.size(); ++i) {
+		buffer[i] = static_cast<std::byte>(i * 31u + 1u);
+	}
+
+	const auto file = (opts.file_size != 0u) ? std::make_unique<bench_file>(opts.file_size) : nullptr;
+
+	for (const algorithm * a: selected) {
+		// buffers are in cache after first pass
+		for (size_t sz: opts.sizes) {
+			const auto input = std::span<const std::byte>(buffer).first(sz);
+
+			results.push_back(measure(a->name, std::to_string(sz), opts.duration, [&] {
+				auto h = a->create();
+				h->update(input);
+				volatile auto d = h->final().bytes[0];
+				static_cast<void>(d);
+				return input.size();
+			}));
+		}
+
+		if (file && file->valid()) {
+			results.push_back(measure(a->name, "file", opts.duration, [&] {
+				file->drop_cache();
+				auto h = a->create();
+				map_file(file->fd, file->size, map_options{}, [&](std::span<const std::byte> chunk) { h->update(chunk); });
+				volatile auto d = h->final().bytes[0];
+				static_cast<void>(d);
+				return file->size;
+			}));
+		}
+	}
+
+	return results;
+}
+
+inline void print_bench(std::ostream & out, std::span<const bench_result> results, const bench_result & bandwidth, bool json) {
+	const bool ticks = have_tick_counter();
+
+	if (json) {
+		out << "{\n  \"backend\": \"" << bench_backend() << "\",\n";
+		out << "  \"memory_read_gbps\": " << bandwidth.gbps() << ",\n";
+		out << "  \"results\": [\n";
+
+		for (size_t i = 0; i != results.size(); ++i) {
+			const auto & r = results[i];
+			out << "    {\"algorithm\": \"" << r.algorithm << "\", \"input\": \"" << r.input << "\", \"gbps\": " << r.gbps();
+			if (ticks) {
+				out << ", \"tsc_ticks_per_byte\": " << r.ticks_per_byte();
+			}
+			out << "}" << (i + 1u != results.size() ? "," : "") << "\n";
+		}
+
+		out << "  ]\n}\n";
+		return;
+	}
+
+	char line[128];
+
+	out << "backend: " << bench_backend() << "\n";
+	std::snprintf(line, sizeof(line), "memory read: %.2f GB/s\n\n", bandwidth.gbps());
+	out << line;
+
+	std::snprintf(line, sizeof(line), "%-16s %10s %10s %12s\n", "algorithm", "input", "GB/s", "TSC ticks/B");
+	out << line;
+
+	for (const auto & r: results) {
+		if (ticks) {
+			std::snprintf(line, sizeof(line), "%-16.*s %10s %10.3f %12.2f\n", static_cast<int>(r.algorithm.size()), r.algorithm.data(), r.input.c_str(), r.gbps(), r.ticks_per_byte());
+		} else {
+			std::snprintf(line, sizeof(line), "%-16.*s %10s %10.3f %12s\n", static_cast<int>(r.algorithm.size()), r.algorithm.data(), r.input.c_str(), r.gbps(), "n/a");
+		}
+		out << line;
+	}
+}
+
+#endif
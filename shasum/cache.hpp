@@ -0,0 +1,383 @@
+#ifndef CTHASH_SHASUM_CACHE_HPP
+#define CTHASH_SHASUM_CACHE_HPP
+
+#include "algorithms.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// persistent cache of digests: append-only log of records (`path`) and open-addressing index into it
+// (`path.index`), index is only an acceleration structure and it's rebuilt from the log when it doesn't
+// match, files are identified by device, inode, size, mtime and ctime (any change means new record)
+
+struct file_identity {
+	uint64_t device{0};
+	uint64_t inode{0};
+	uint64_t size{0};
+	int64_t mtime_sec{0};
+	int64_t mtime_nsec{0};
+	int64_t ctime_sec{0};
+	int64_t ctime_nsec{0};
+
+	static file_identity of(const struct stat & info) noexcept {
+		return file_identity{static_cast<uint64_t>(info.st_dev), static_cast<uint64_t>(info.st_ino), static_cast<uint64_t>(info.st_size), info.st_mtim.tv_sec, info.st_mtim.tv_nsec, info.st_ctim.tv_sec, info.st_ctim.tv_nsec};
+	}
+
+	friend bool operator==(const file_identity &, const file_identity &) noexcept = default;
+};
+
+// record has space for the longest digest shasum produces (SHAKE with 2048 bits of output)
+struct cache_record {
+	static constexpr size_t max_digest_length = std::tuple_size_v<decltype(::digest::bytes)>;
+
+	file_identity identity;
+	char algorithm[16];
+	uint64_t length;
+	std::byte digest[max_digest_length];
+
+	bool matches(const file_identity & id, std::string_view name) const noexcept {
+		return identity == id && std::string_view(algorithm, strnlen(algorithm, sizeof(algorithm))) == name;
+	}
+};
+
+static_assert(sizeof(cache_record) == 336u);
+
+struct digest_cache {
+	static constexpr uint64_t log_magic = 0x32474f4c48534843ull;   // "CHSHLOG2"
+	static constexpr uint64_t index_magic = 0x31584449'48534843ull; // "CHSHIDX1"
+
+	struct log_header {
+		uint64_t magic;
+		uint64_t count; // committed records
+	};
+
+	struct index_header {
+		uint64_t magic;
+		uint64_t capacity; // power of two
+		uint64_t used;
+		uint64_t indexed; // number of log records in the index
+	};
+
+	// 32 bits of key hash (to skip most mismatches without touching the log) and record number + 1
+	using slot = uint64_t;
+
+	// record numbers must fit into lower half of a slot
+	static constexpr uint64_t max_records = 0xFFFF'FFFEull;
+
+	std::mutex lock;
+
+	int log_fd{-1};
+	std::byte * log_map{nullptr};
+	size_t log_mapped{0};
+
+	int index_fd{-1};
+	std::byte * index_map{nullptr};
+	size_t index_mapped{0};
+
+	size_t hits{0};
+	size_t misses{0};
+
+	explicit digest_cache(const std::string & path) {
+		log_fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+		index_fd = open((path + ".index").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+		if (log_fd == -1 || index_fd == -1) {
+			close_all();
+			return;
+		}
+
+		// other shasum processes using the same cache wait
+		flock(log_fd, LOCK_EX);
+
+		if (!open_log() || !open_index()) {
+			close_all();
+		}
+	}
+
+	digest_cache(const digest_cache &) = delete;
+	digest_cache(digest_cache &&) = delete;
+
+	~digest_cache() {
+		close_all();
+	}
+
+	bool valid() const noexcept {
+		return log_map != nullptr && index_map != nullptr;
+	}
+
+	// files which changed in last two seconds can change again with the same timestamps
+	static bool is_stable(const file_identity & id) noexcept {
+		const auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+		return std::max(id.mtime_sec, id.ctime_sec) + 2 < static_cast<int64_t>(now);
+	}
+
+	auto find(const file_identity & id, std::string_view algorithm) -> std::optional<digest> {
+		const auto guard = std::lock_guard{lock};
+
+		// cache which failed to grow is not used anymore
+		if (!valid()) {
+			++misses;
+			return std::nullopt;
+		}
+
+		const uint64_t h = hash_of(id, algorithm);
+		const uint64_t mask = index()->capacity - 1u;
+
+		for (uint64_t i = h & mask;; i = (i + 1u) & mask) {
+			const slot s = slots()[i];
+
+			if (s == 0u) {
+				++misses;
+				return std::nullopt;
+			}
+
+			if ((s >> 32u) != (h >> 32u)) {
+				continue;
+			}
+
+			const cache_record & r = record(static_cast<uint32_t>(s) - 1u);
+
+			if (r.matches(id, algorithm)) {
+				++hits;
+				digest output;
+				output.length = r.length;
+				std::copy_n(r.digest, r.length, output.bytes.begin());
+				return output;
+			}
+		}
+	}
+
+	void insert(const file_identity & id, std::string_view algorithm, const digest & value) {
+		if (value.length > cache_record::max_digest_length || algorithm.size() >= sizeof(cache_record::algorithm) || !is_stable(id)) {
+			return;
+		}
+
+		const auto guard = std::lock_guard{lock};
+
+		if (!valid()) {
+			return;
+		}
+
+		cache_record r{};
+		r.identity = id;
+		std::copy(algorithm.begin(), algorithm.end(), r.algorithm);
+		r.length = value.length;
+		std::copy_n(value.bytes.begin(), value.length, r.digest);
+
+		if (!append(r) || !index_record(log()->count - 1u)) {
+			return;
+		}
+
+		index()->indexed = log()->count;
+	}
+
+private:
+	static uint64_t mix(uint64_t h, uint64_t v) noexcept {
+		h ^= v + 0x9e3779b97f4a7c15ull + (h << 6u) + (h >> 2u);
+		h ^= h >> 31u;
+		h *= 0xbf58476d1ce4e5b9ull;
+		return h;
+	}
+
+	static uint64_t hash_of(const file_identity & id, std::string_view algorithm) noexcept {
+		uint64_t h = mix(mix(mix(0u, id.device), id.inode), id.size);
+		h = mix(mix(h, static_cast<uint64_t>(id.mtime_sec)), static_cast<uint64_t>(id.mtime_nsec));
+		h = mix(mix(h, static_cast<uint64_t>(id.ctime_sec)), static_cast<uint64_t>(id.ctime_nsec));
+
+		for (char c: algorithm) {
+			h = mix(h, static_cast<unsigned char>(c));
+		}
+
+		return h;
+	}
+
+	log_header * log() const noexcept {
+		return reinterpret_cast<log_header *>(log_map);
+	}
+
+	index_header * index() const noexcept {
+		return reinterpret_cast<index_header *>(index_map);
+	}
+
+	slot * slots() const noexcept {
+		return reinterpret_cast<slot *>(index_map + sizeof(index_header));
+	}
+
+	const cache_record & record(uint64_t n) const noexcept {
+		return *reinterpret_cast<const cache_record *>(log_map + sizeof(log_header) + n * sizeof(cache_record));
+	}
+
+	static std::byte * remap(int fd, std::byte * old, size_t old_size, size_t size) {
+		if (old != nullptr) {
+			munmap(old, old_size);
+		}
+
+		if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+			return nullptr;
+		}
+
+		void * r = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		return (r != MAP_FAILED) ? static_cast<std::byte *>(r) : nullptr;
+	}
+
+	bool open_log() {
+		struct stat info {};
+		if (fstat(log_fd, &info) != 0) {
+			return false;
+		}
+
+		log_mapped = std::max<size_t>(static_cast<size_t>(info.st_size), 1024u * 1024u);
+
+		// mapping is bigger than file (file is extended in steps)
+		if (static_cast<size_t>(info.st_size) < log_mapped && ftruncate(log_fd, static_cast<off_t>(log_mapped)) != 0) {
+			return false;
+		}
+
+		void * r = mmap(nullptr, log_mapped, PROT_READ | PROT_WRITE, MAP_SHARED, log_fd, 0);
+		if (r == MAP_FAILED) {
+			return false;
+		}
+		log_map = static_cast<std::byte *>(r);
+
+		if (log()->magic != log_magic) {
+			// new (or unknown) file is started from scratch
+			log()->magic = log_magic;
+			log()->count = 0u;
+		}
+
+		// partially written file is trimmed to what fits into the mapping
+		log()->count = std::min<uint64_t>({log()->count, (log_mapped - sizeof(log_header)) / sizeof(cache_record), max_records});
+		return true;
+	}
+
+	// full log stays usable for lookups, new digests are just not remembered
+	bool append(const cache_record & r) {
+		if (log()->count >= max_records) {
+			return false;
+		}
+
+		const size_t needed = sizeof(log_header) + (log()->count + 1u) * sizeof(cache_record);
+
+		if (needed > log_mapped) {
+			const size_t size = log_mapped * 2u;
+			log_map = remap(log_fd, log_map, log_mapped, size);
+			log_mapped = log_map != nullptr ? size : 0u;
+
+			if (log_map == nullptr) {
+				return false;
+			}
+		}
+
+		std::memcpy(log_map + sizeof(log_header) + log()->count * sizeof(cache_record), &r, sizeof(r));
+		// record is written before it's counted
+		std::atomic_thread_fence(std::memory_order_release);
+		log()->count += 1u;
+		return true;
+	}
+
+	static size_t index_size(uint64_t capacity) noexcept {
+		return sizeof(index_header) + capacity * sizeof(slot);
+	}
+
+	bool open_index() {
+		struct stat info {};
+		if (fstat(index_fd, &info) != 0) {
+			return false;
+		}
+
+		if (static_cast<size_t>(info.st_size) >= sizeof(index_header)) {
+			void * r = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, index_fd, 0);
+
+			if (r != MAP_FAILED) {
+				index_map = static_cast<std::byte *>(r);
+				index_mapped = static_cast<size_t>(info.st_size);
+
+				const auto * h = index();
+				const bool consistent = h->magic == index_magic && std::has_single_bit(h->capacity) && index_size(h->capacity) == index_mapped && h->indexed == log()->count && h->used * 2u <= h->capacity;
+
+				if (consistent) {
+					return true;
+				}
+			}
+		}
+
+		return rebuild_index(std::max<uint64_t>(1024u, std::bit_ceil(log()->count * 2u + 2u)));
+	}
+
+	bool rebuild_index(uint64_t capacity) {
+		index_map = remap(index_fd, index_map, index_mapped, index_size(capacity));
+		index_mapped = index_map != nullptr ? index_size(capacity) : 0u;
+
+		if (index_map == nullptr) {
+			return false;
+		}
+
+		std::memset(index_map, 0, index_mapped);
+		index()->magic = index_magic;
+		index()->capacity = capacity;
+
+		for (uint64_t n = 0; n != log()->count; ++n) {
+			if (!index_record(n)) {
+				return false;
+			}
+		}
+
+		index()->indexed = log()->count;
+		return true;
+	}
+
+	// failure leaves cache without index (invalid)
+	bool index_record(uint64_t n) {
+		if ((index()->used + 1u) * 2u > index()->capacity) {
+			// rebuild will index this record too
+			return rebuild_index(index()->capacity * 2u);
+		}
+
+		const cache_record & r = record(n);
+		const uint64_t h = hash_of(r.identity, std::string_view(r.algorithm, strnlen(r.algorithm, sizeof(r.algorithm))));
+		const uint64_t mask = index()->capacity - 1u;
+
+		uint64_t i = h & mask;
+		while (slots()[i] != 0u) {
+			i = (i + 1u) & mask;
+		}
+
+		slots()[i] = (h & 0xFFFF'FFFF'0000'0000ull) | (n + 1u);
+		index()->used += 1u;
+		return true;
+	}
+
+	void close_all() {
+		if (index_map != nullptr) {
+			munmap(index_map, index_mapped);
+			index_map = nullptr;
+		}
+		if (log_map != nullptr) {
+			munmap(log_map, log_mapped);
+			log_map = nullptr;
+		}
+		if (index_fd != -1) {
+			close(index_fd);
+			index_fd = -1;
+		}
+		if (log_fd != -1) {
+			flock(log_fd, LOCK_UN);
+			close(log_fd);
+			log_fd = -1;
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef CTHASH_SHASUM_DECOMPRESS_HPP
+#define CTHASH_SHASUM_DECOMPRESS_HPP
+
+#include "algorithms.hpp"
+#include <cthash/dual_digest.hpp>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <variant>
+#include <cstddef>
+#ifdef SHASUM_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef SHASUM_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+// decoders of compressed streams for cthash::dual_digest (support depends on libraries found by build)
+
+#ifdef SHASUM_HAVE_ZLIB
+// gzip (including concatenated members) and zlib streams
+struct gzip_decoder {
+	std::unique_ptr<z_stream, void (*)(z_stream *)> stream{new z_stream{}, [](z_stream * s) {
+		inflateEnd(s);
+		delete s;
+	}};
+	bool initialized{false};
+	bool end{false};
+
+	gzip_decoder() {
+		// 32 means automatic detection of gzip or zlib header
+		initialized = inflateInit2(stream.get(), 15 + 32) == Z_OK;
+	}
+
+	cthash::decode_step decode(std::span<const std::byte> in, std::span<std::byte> out) {
+		if (!initialized) {
+			return cthash::decode_step{.error = true};
+		}
+
+		// next member of concatenated gzip file
+		if (end && !in.empty()) {
+			if (inflateReset(stream.get()) != Z_OK) {
+				return cthash::decode_step{.error = true};
+			}
+			end = false;
+		}
+
+		stream->next_in = reinterpret_cast<Bytef *>(const_cast<std::byte *>(in.data()));
+		stream->avail_in = static_cast<uInt>(std::min<size_t>(in.size(), std::numeric_limits<uInt>::max()));
+		stream->next_out = reinterpret_cast<Bytef *>(out.data());
+		stream->avail_out = static_cast<uInt>(std::min<size_t>(out.size(), std::numeric_limits<uInt>::max()));
+
+		const uInt avail_in = stream->avail_in;
+		const uInt avail_out = stream->avail_out;
+
+		const int r = inflate(stream.get(), Z_NO_FLUSH);
+
+		const auto step = cthash::decode_step{avail_in - stream->avail_in, avail_out - stream->avail_out, false};
+
+		if (r == Z_STREAM_END) {
+			end = true;
+		} else if (r != Z_OK && !(r == Z_BUF_ERROR && in.empty())) {
+			return cthash::decode_step{step.consumed, step.produced, true};
+		}
+
+		return step;
+	}
+
+	bool finished() const noexcept {
+		return end;
+	}
+};
+#endif
+
+#ifdef SHASUM_HAVE_ZSTD
+struct zstd_decoder {
+	std::unique_ptr<ZSTD_DStream, size_t (*)(ZSTD_DStream *)> stream{ZSTD_createDStream(), ZSTD_freeDStream};
+	bool end{false};
+
+	cthash::decode_step decode(std::span<const std::byte> in, std::span<std::byte> out) {
+		ZSTD_inBuffer input{in.data(), in.size(), 0u};
+		ZSTD_outBuffer output{out.data(), out.size(), 0u};
+
+		const size_t r = ZSTD_decompressStream(stream.get(), &output, &input);
+
+		if (ZSTD_isError(r)) {
+			return cthash::decode_step{input.pos, output.pos, true};
+		}
+
+		// zero means end of frame, next frame can follow
+		end = (r == 0u);
+		return cthash::decode_step{input.pos, output.pos, false};
+	}
+
+	bool finished() const noexcept {
+		return end;
+	}
+};
+#endif
+
+// format is recognized from first bytes of input
+struct auto_decoder {
+	std::variant<std::monostate
+#ifdef SHASUM_HAVE_ZLIB
+		,
+		gzip_decoder
+#endif
+#ifdef SHASUM_HAVE_ZSTD
+		,
+		zstd_decoder
+#endif
+		>
+		decoder{};
+
+	static bool is_gzip(std::span<const std::byte> in) noexcept {
+		return in.size() >= 2u && in[0] == std::byte{0x1F} && in[1] == std::byte{0x8B};
+	}
+
+	static bool is_zlib(std::span<const std::byte> in) noexcept {
+		// compression method 8 and header checksum
+		return in.size() >= 2u && (std::to_integer<unsigned>(in[0]) & 0x0Fu) == 8u && (std::to_integer<unsigned>(in[0]) * 256u + std::to_integer<unsigned>(in[1])) % 31u == 0u;
+	}
+
+	static bool is_zstd(std::span<const std::byte> in) noexcept {
+		return in.size() >= 4u && in[0] == std::byte{0x28} && in[1] == std::byte{0xB5} && in[2] == std::byte{0x2F} && in[3] == std::byte{0xFD};
+	}
+
+	bool select(std::span<const std::byte> in) {
+#ifdef SHASUM_HAVE_ZLIB
+		if (is_gzip(in) || is_zlib(in)) {
+			decoder.emplace<gzip_decoder>();
+			return true;
+		}
+#endif
+#ifdef SHASUM_HAVE_ZSTD
+		if (is_zstd(in)) {
+			decoder.emplace<zstd_decoder>();
+			return true;
+		}
+#endif
+		static_cast<void>(in);
+		return false;
+	}
+
+	cthash::decode_step decode(std::span<const std::byte> in, std::span<std::byte> out) {
+		if (std::holds_alternative<std::monostate>(decoder) && !select(in)) {
+			return cthash::decode_step{.error = true};
+		}
+
+		return std::visit([&]<typename T>(T & d) {
+			if constexpr (std::same_as<T, std::monostate>) {
+				return cthash::decode_step{.error = true};
+			} else {
+				return d.decode(in, out);
+			}
+		},
+			decoder);
+	}
+
+	bool finished() const noexcept {
+		return std::visit([]<typename T>(const T & d) {
+			if constexpr (std::same_as<T, std::monostate>) {
+				return false;
+			} else {
+				return d.finished();
+			}
+		},
+			decoder);
+	}
+};
+
+inline std::string_view supported_compressions() noexcept {
+#if defined(SHASUM_HAVE_ZLIB) && defined(SHASUM_HAVE_ZSTD)
+	return "gzip, zlib, zstd";
+#elif defined(SHASUM_HAVE_ZLIB)
+	return "gzip, zlib";
+#elif defined(SHASUM_HAVE_ZSTD)
+	return "zstd";
+#else
+	return "none";
+#endif
+}
+
+// runtime hasher adapter (dual_digest takes hashers by value)
+struct dynamic_hasher {
+	std::unique_ptr<any_hasher> impl;
+
+	void update(std::span<const std::byte> in) {
+		impl->update(in);
+	}
+
+	digest final() {
+		return impl->final();
+	}
+};
+
+using decompressing_hasher = cthash::dual_digest<dynamic_hasher, dynamic_hasher, auto_decoder>;
+
+#endif
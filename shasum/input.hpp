@@ -0,0 +1,238 @@
+#ifndef CTHASH_SHASUM_INPUT_HPP
+#define CTHASH_SHASUM_INPUT_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <semaphore>
+#include <span>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// whole file mapped into memory (only regular files can be mapped)
+struct mapped_file {
+	static constexpr int invalid = -1;
+
+	int fd{invalid};
+	size_t sz{0};
+	void * ptr{nullptr};
+	bool regular{false};
+
+	static bool is_regular(int fd) {
+		struct stat info {};
+		return fd != invalid && fstat(fd, &info) == 0 && S_ISREG(info.st_mode);
+	}
+
+	static size_t get_size(int fd) {
+		struct stat info {};
+		if (fd == invalid || fstat(fd, &info) != 0) {
+			return 0;
+		}
+
+		return static_cast<size_t>(info.st_size);
+	}
+
+	static void * map(int fd, size_t sz) {
+		// empty file can't be mapped
+		if (fd == invalid || sz == 0u) {
+			return nullptr;
+		}
+
+		void * r = mmap(nullptr, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (r == MAP_FAILED) {
+			return nullptr;
+		}
+
+		madvise(r, sz, MADV_SEQUENTIAL);
+		return r;
+	}
+
+	mapped_file(const char * path): fd{open(path, O_RDONLY)}, regular{is_regular(fd)} {
+		if (regular) {
+			sz = get_size(fd);
+			ptr = map(fd, sz);
+		}
+	}
+
+	mapped_file(const mapped_file &) = delete;
+	mapped_file(mapped_file &&) = delete;
+
+	~mapped_file() {
+		if (ptr) {
+			munmap(ptr, sz);
+		}
+		if (fd != invalid) {
+			close(fd);
+		}
+	}
+
+	bool valid() const noexcept {
+		return regular && (ptr != nullptr || sz == 0u);
+	}
+
+	auto get_span() const noexcept {
+		return std::span<const std::byte>(reinterpret_cast<std::byte *>(ptr), sz);
+	}
+};
+
+struct map_options {
+	size_t window{64u * 1024u * 1024u}; // must be multiple of huge page size
+	unsigned ahead{2u};					// number of windows populated by prefetch thread in advance
+	bool prefetch{true};
+};
+
+namespace input_detail {
+
+struct window {
+	void * ptr{nullptr};
+	size_t size{0};
+};
+
+inline void * map_window(int fd, uint64_t offset, size_t size, bool populate) {
+	void * r = mmap(nullptr, size, PROT_READ, MAP_PRIVATE | (populate ? MAP_POPULATE : 0), fd, static_cast<off_t>(offset));
+
+	if (r == MAP_FAILED) {
+		return nullptr;
+	}
+
+	// hints only, errors are not interesting (huge pages for files depend on filesystem)
+	madvise(r, size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+	madvise(r, size, MADV_HUGEPAGE);
+#endif
+
+	return r;
+}
+
+} // namespace input_detail
+
+// file is mapped in windows so address space stays bounded, bigger files have windows mapped
+// with MAP_POPULATE by prefetch thread while previous window is hashed
+template <typename Fn> bool map_file(int fd, uint64_t size, const map_options & opts, Fn && callback) {
+	using input_detail::window;
+
+	const auto window_at = [&](uint64_t offset) {
+		return static_cast<size_t>(std::min<uint64_t>(opts.window, size - offset));
+	};
+
+	if (!opts.prefetch || size <= opts.window) {
+		for (uint64_t offset = 0; offset < size;) {
+			const size_t length = window_at(offset);
+			void * ptr = input_detail::map_window(fd, offset, length, false);
+
+			if (ptr == nullptr) {
+				return false;
+			}
+
+			madvise(ptr, length, MADV_WILLNEED);
+			callback(std::span<const std::byte>(static_cast<const std::byte *>(ptr), length));
+			munmap(ptr, length);
+			offset += length;
+		}
+		return true;
+	}
+
+	const size_t count = std::max(opts.ahead, 1u) + 1u;
+	std::vector<window> windows(count);
+	std::counting_semaphore<> empty(static_cast<std::ptrdiff_t>(count));
+	std::counting_semaphore<> full(0);
+	std::atomic<bool> cancelled{false};
+
+	auto prefetcher = std::jthread([&] {
+		for (uint64_t offset = 0, slot = 0; offset < size; slot = (slot + 1u) % count) {
+			empty.acquire();
+
+			if (cancelled) {
+				return;
+			}
+
+			const size_t length = window_at(offset);
+			windows[slot] = window{input_detail::map_window(fd, offset, length, true), length};
+			offset += length;
+
+			full.release();
+
+			if (windows[slot].ptr == nullptr) {
+				return;
+			}
+		}
+	});
+
+	bool success = true;
+
+	for (uint64_t offset = 0, slot = 0; offset < size; slot = (slot + 1u) % count) {
+		full.acquire();
+		const window w = windows[slot];
+
+		if (w.ptr == nullptr) {
+			success = false;
+			break;
+		}
+
+		callback(std::span<const std::byte>(static_cast<const std::byte *>(w.ptr), w.size));
+		munmap(w.ptr, w.size);
+		offset += w.size;
+
+		empty.release();
+	}
+
+	if (!success) {
+		cancelled = true;
+		empty.release();
+	}
+
+	return success;
+}
+
+// read whole input from descriptor (pipes, character devices, sockets) and give it to callback in chunks
+template <typename Fn> bool read_stream(int fd, Fn && callback) {
+	constexpr size_t buffer_size = 4u * 1024u * 1024u;
+
+#ifdef F_SETPIPE_SZ
+	// bigger pipe means less context switches with writer (fails for other types, which is fine)
+	fcntl(fd, F_SETPIPE_SZ, 1024 * 1024);
+#endif
+
+	std::vector<std::byte> buffer(buffer_size);
+
+	for (;;) {
+		// fill buffer as much as possible so callback is not called for every small write into pipe
+		size_t used = 0;
+		bool end = false;
+
+		while (used < buffer.size()) {
+			const ssize_t r = read(fd, buffer.data() + used, buffer.size() - used);
+
+			if (r < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return false;
+			}
+
+			if (r == 0) {
+				end = true;
+				break;
+			}
+
+			used += static_cast<size_t>(r);
+		}
+
+		if (used != 0u) {
+			callback(std::span<const std::byte>(buffer.data(), used));
+		}
+
+		if (end) {
+			return true;
+		}
+	}
+}
+
+#endif
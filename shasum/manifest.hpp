@@ -0,0 +1,173 @@
+#ifndef CTHASH_SHASUM_MANIFEST_HPP
+#define CTHASH_SHASUM_MANIFEST_HPP
+
+#include "algorithms.hpp"
+#include <array>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstring>
+
+// one line of manifest (`digest  path` from GNU tools or `NAME (path) = digest` from BSD tools)
+struct manifest_entry {
+	const algorithm * algo{nullptr};
+	digest expected{};
+	std::string path{};
+	size_t line{0};
+};
+
+struct manifest {
+	std::vector<manifest_entry> entries;
+	size_t malformed{0};
+};
+
+inline bool parse_hex_digest(std::string_view hex, digest & out) noexcept {
+	if (hex.empty() || hex.size() % 2u != 0u || hex.size() / 2u > out.bytes.size()) {
+		return false;
+	}
+
+	if (cthash::internal::decode_hexdec(std::span<const char>(hex), out.bytes.data()) != hex.size()) {
+		return false;
+	}
+
+	out.length = hex.size() / 2u;
+	return true;
+}
+
+// GNU tools don't say which algorithm was used, the length is good enough guess for SHA-2
+inline auto algorithm_by_length(size_t hex_length) -> const algorithm * {
+	switch (hex_length) {
+		case 56: return find_algorithm("sha-224");
+		case 64: return find_algorithm("sha-256");
+		case 96: return find_algorithm("sha-384");
+		case 128: return find_algorithm("sha-512");
+		default: return nullptr;
+	}
+}
+
+// accepts our names and also names used by BSD tools and openssl (SHA256, SHA3-256, SHA512/256, SHA2-256)
+inline auto algorithm_by_tag(std::string_view tag) -> const algorithm * {
+	std::string name;
+	name.reserve(tag.size() + 1u);
+
+	for (char c: tag) {
+		name.push_back((c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c);
+	}
+
+	if (name.starts_with("sha2-")) {
+		name.erase(3u, 1u);
+	} else if (name.starts_with("sha") && name.size() > 3u && name[3] != '-' && !name.starts_with("sha3-")) {
+		name.insert(3u, 1u, '-');
+	}
+
+	return find_algorithm(name);
+}
+
+// GNU tools escape backslash and newline in path and mark such line with backslash
+inline std::string unescape_path(std::string_view path) {
+	std::string output;
+	output.reserve(path.size());
+
+	for (size_t i = 0; i != path.size(); ++i) {
+		if (path[i] == '\\' && i + 1u != path.size()) {
+			++i;
+			output.push_back(path[i] == 'n' ? '\n' : path[i]);
+		} else {
+			output.push_back(path[i]);
+		}
+	}
+
+	return output;
+}
+
+// `forced` is used for all GNU lines when user specified algorithm
+inline bool parse_manifest_line(std::string_view line, const algorithm * forced, manifest_entry & out) {
+	if (!line.empty() && line.back() == '\r') {
+		line.remove_suffix(1u);
+	}
+
+	const bool escaped = !line.empty() && line.front() == '\\';
+	if (escaped) {
+		line.remove_prefix(1u);
+	}
+
+	const auto path_of = [escaped](std::string_view p) { return escaped ? unescape_path(p) : std::string(p); };
+
+	// BSD: NAME (path) = digest, openssl: NAME(path)= digest
+	if (const auto open = line.find('('); open != std::string_view::npos && open != 0u) {
+		const auto close = line.rfind(')');
+		const auto tag = line.substr(0, line[open - 1u] == ' ' ? open - 1u : open);
+		const algorithm * tagged = (close != std::string_view::npos && close > open) ? algorithm_by_tag(tag) : nullptr;
+
+		if (tagged != nullptr) {
+			auto value = line.substr(close + 1u);
+
+			if (!value.starts_with(" = ") && !value.starts_with("= ")) {
+				return false;
+			}
+
+			value.remove_prefix(value.find('=') + 2u);
+			out.algo = tagged;
+
+			if (!parse_hex_digest(value, out.expected)) {
+				return false;
+			}
+
+			out.path = path_of(line.substr(open + 1u, close - open - 1u));
+			return true;
+		}
+	}
+
+	// GNU: digest, space, space or asterisk (binary mode), path
+	const auto space = line.find(' ');
+
+	if (space == std::string_view::npos || space + 2u > line.size() || (line[space + 1u] != ' ' && line[space + 1u] != '*')) {
+		return false;
+	}
+
+	const auto hex = line.substr(0, space);
+	out.algo = (forced != nullptr) ? forced : algorithm_by_length(hex.size());
+
+	if (out.algo == nullptr || !parse_hex_digest(hex, out.expected)) {
+		return false;
+	}
+
+	out.path = path_of(line.substr(space + 2u));
+	return !out.path.empty();
+}
+
+// lines are found with memchr over the whole manifest, empty lines and comments are skipped
+inline auto parse_manifest(std::span<const std::byte> content, const algorithm * forced) -> manifest {
+	manifest output;
+
+	const char * it = reinterpret_cast<const char *>(content.data());
+	const char * const end = it + content.size();
+	size_t number = 0;
+
+	while (it != end) {
+		const auto * nl = static_cast<const char *>(std::memchr(it, '\n', static_cast<size_t>(end - it)));
+		const char * line_end = (nl != nullptr) ? nl : end;
+		const auto line = std::string_view(it, static_cast<size_t>(line_end - it));
+
+		it = (nl != nullptr) ? nl + 1 : end;
+		++number;
+
+		if (line.empty() || line == "\r" || line.front() == '#') {
+			continue;
+		}
+
+		manifest_entry entry;
+		entry.line = number;
+
+		if (parse_manifest_line(line, forced, entry)) {
+			output.entries.push_back(std::move(entry));
+		} else {
+			++output.malformed;
+		}
+	}
+
+	return output;
+}
+
+#endif
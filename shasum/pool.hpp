@@ -0,0 +1,120 @@
+#ifndef CTHASH_SHASUM_POOL_HPP
+#define CTHASH_SHASUM_POOL_HPP
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+
+struct task {
+	size_t index;  // position in input (for ordering of output)
+	uint64_t size; // expected amount of work
+};
+
+// each worker has its own queue, when it's empty the worker steals from the others
+struct work_stealing_pool {
+	struct queue {
+		std::mutex lock;
+		std::deque<task> items;
+
+		std::optional<task> pop_front() {
+			const auto guard = std::lock_guard{lock};
+			if (items.empty()) {
+				return std::nullopt;
+			}
+			const task t = items.front();
+			items.pop_front();
+			return t;
+		}
+
+		std::optional<task> pop_back() {
+			const auto guard = std::lock_guard{lock};
+			if (items.empty()) {
+				return std::nullopt;
+			}
+			const task t = items.back();
+			items.pop_back();
+			return t;
+		}
+	};
+
+	std::deque<queue> queues;
+
+	// largest tasks are distributed first, so the small ones are balancing the tail
+	work_stealing_pool(std::vector<task> tasks, unsigned workers): queues(std::max(workers, 1u)) {
+		std::stable_sort(tasks.begin(), tasks.end(), [](const task & lhs, const task & rhs) { return lhs.size > rhs.size; });
+
+		for (size_t i = 0; i != tasks.size(); ++i) {
+			queues[i % queues.size()].items.push_back(tasks[i]);
+		}
+	}
+
+	// owner takes largest task from its queue, thief takes smallest from other queue
+	std::optional<task> take(size_t worker) {
+		if (auto t = queues[worker].pop_front()) {
+			return t;
+		}
+
+		for (size_t i = 1; i != queues.size(); ++i) {
+			if (auto t = queues[(worker + i) % queues.size()].pop_back()) {
+				return t;
+			}
+		}
+
+		return std::nullopt;
+	}
+
+	template <typename Fn> void run(Fn && fn) {
+		if (queues.size() == 1u) {
+			while (auto t = take(0u)) {
+				fn(*t);
+			}
+			return;
+		}
+
+		std::vector<std::jthread> threads;
+		threads.reserve(queues.size());
+
+		for (size_t w = 0; w != queues.size(); ++w) {
+			threads.emplace_back([this, w, &fn] {
+				while (auto t = take(w)) {
+					fn(*t);
+				}
+			});
+		}
+	}
+};
+
+// results are printed in input order as soon as all previous results are printed
+struct reorder_buffer {
+	std::mutex lock;
+	std::vector<std::optional<std::string>> pending;
+	size_t next{0};
+	std::ostream & output;
+
+	reorder_buffer(size_t count, std::ostream & out): pending(count), output{out} { }
+
+	void complete(size_t index, std::string text) {
+		const auto guard = std::lock_guard{lock};
+		pending[index] = std::move(text);
+
+		bool written = false;
+		while (next != pending.size() && pending[next].has_value()) {
+			output << *pending[next];
+			pending[next].reset();
+			++next;
+			written = true;
+		}
+
+		if (written) {
+			output.flush();
+		}
+	}
+};
+
+#endif
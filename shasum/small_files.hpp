@@ -0,0 +1,234 @@
+#ifndef CTHASH_SHASUM_SMALL_FILES_HPP
+#define CTHASH_SHASUM_SMALL_FILES_HPP
+
+#include "uring.hpp"
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+
+// small files are loaded in batches into one arena: all files of a batch are opened, then read and closed
+// with a single io_uring submission per step (or plain syscalls when io_uring is not available), so
+// they can be hashed together in lanes
+
+struct small_files_options {
+	size_t max_size{16u * 1024u}; // bigger files are hashed one by one
+	size_t batch{256u};
+};
+
+struct small_file_loader {
+	small_files_options opts;
+	uring_queue ring;
+	std::vector<std::byte> arena;
+	std::vector<int> fds;
+	std::vector<int> results;
+	size_t handed{0}; // requests of last step which reached kernel
+	bool usable{false};
+
+	// result of a request which didn't complete
+	static constexpr int pending = std::numeric_limits<int>::min();
+
+	// IORING_OP_OPENAT and IORING_OP_CLOSE are available since Linux 5.6, older kernels use plain syscalls
+	explicit small_file_loader(const small_files_options & o): opts{o}, ring(static_cast<unsigned>(o.batch)), arena(o.batch * (o.max_size + 1u)), fds(o.batch), results(o.batch) {
+		usable = ring.valid() && ring.supports(IORING_OP_OPENAT) && ring.supports(IORING_OP_READ) && ring.supports(IORING_OP_CLOSE);
+	}
+
+	// slot is one byte bigger than limit, so file which grew since it was listed is recognized
+	std::byte * slot(size_t i) noexcept {
+		return arena.data() + i * (opts.max_size + 1u);
+	}
+
+	size_t slot_size() const noexcept {
+		return opts.max_size + 1u;
+	}
+
+	// every operation of the batch is submitted at once, then all completions are collected
+	template <typename Prepare> bool run_step(size_t count, Prepare && prepare) {
+		size_t submitted = 0;
+		handed = 0u;
+		std::fill_n(results.begin(), count, pending);
+
+		for (size_t i = 0; i != count; ++i) {
+			io_uring_sqe * sqe = ring.push();
+
+			if (sqe == nullptr) {
+				ring.discard();
+				return false;
+			}
+
+			if (prepare(i, *sqe)) {
+				sqe->user_data = i;
+				++submitted;
+			} else {
+				sqe->opcode = IORING_OP_NOP;
+				sqe->user_data = ~uint64_t{0};
+				++submitted;
+			}
+		}
+
+		// kernel consumes entries in order, so the first ones of the batch were given to it
+		if (!ring.submit()) {
+			handed = submitted - ring.prepared;
+			ring.discard();
+			return abandon(0u);
+		}
+
+		handed = submitted;
+
+		for (size_t i = 0; i != submitted; ++i) {
+			io_uring_cqe cqe{};
+
+			if (!ring.wait(cqe)) {
+				return abandon(i);
+			}
+
+			record(cqe);
+		}
+
+		return true;
+	}
+
+	void record(const io_uring_cqe & cqe) noexcept {
+		if (cqe.user_data != ~uint64_t{0}) {
+			results[cqe.user_data] = cqe.res;
+		}
+	}
+
+	// requests which reached kernel are still collected, so the caller sees every opened descriptor and
+	// no read writes into arena later, only when that fails too the ring is not used anymore
+	bool abandon(size_t collected) {
+		for (; collected != handed; ++collected) {
+			io_uring_cqe cqe{};
+
+			if (!ring.wait(cqe)) {
+				usable = false;
+				break;
+			}
+
+			record(cqe);
+		}
+
+		return false;
+	}
+
+	bool load_with_uring(std::span<const std::string> paths) {
+		const size_t count = paths.size();
+
+		const bool opened = run_step(count, [&](size_t i, io_uring_sqe & sqe) {
+			sqe.opcode = IORING_OP_OPENAT;
+			sqe.fd = AT_FDCWD;
+			sqe.addr = reinterpret_cast<uint64_t>(paths[i].c_str());
+			sqe.open_flags = O_RDONLY | O_CLOEXEC;
+			return true;
+		});
+
+		// descriptors which were already opened are closed, files are opened again with syscalls
+		if (!opened) {
+			for (size_t i = 0; i != count; ++i) {
+				if (results[i] >= 0) {
+					close(results[i]);
+				}
+			}
+			return false;
+		}
+
+		for (size_t i = 0; i != count; ++i) {
+			fds[i] = results[i];
+		}
+
+		const bool read = run_step(count, [&](size_t i, io_uring_sqe & sqe) {
+			results[i] = -EBADF;
+
+			if (fds[i] < 0) {
+				return false;
+			}
+
+			sqe.opcode = IORING_OP_READ;
+			sqe.fd = fds[i];
+			sqe.addr = reinterpret_cast<uint64_t>(slot(i));
+			sqe.len = static_cast<uint32_t>(slot_size());
+			sqe.off = 0u;
+			return true;
+		});
+
+		if (!read) {
+			for (size_t i = 0; i != count; ++i) {
+				if (fds[i] >= 0) {
+					close(fds[i]);
+				}
+			}
+			return false;
+		}
+
+		std::vector<int> lengths(results.begin(), results.begin() + static_cast<std::ptrdiff_t>(count));
+
+		const bool closed = run_step(count, [&](size_t i, io_uring_sqe & sqe) {
+			if (fds[i] < 0) {
+				return false;
+			}
+
+			sqe.opcode = IORING_OP_CLOSE;
+			sqe.fd = fds[i];
+			return true;
+		});
+
+		// requests which reached kernel closed their descriptor, the rest is closed here
+		if (!closed) {
+			for (size_t i = handed; i < count; ++i) {
+				if (fds[i] >= 0) {
+					close(fds[i]);
+				}
+			}
+		}
+
+		std::copy(lengths.begin(), lengths.end(), results.begin());
+		return true;
+	}
+
+	void load_with_syscalls(std::span<const std::string> paths) {
+		for (size_t i = 0; i != paths.size(); ++i) {
+			const int fd = open(paths[i].c_str(), O_RDONLY | O_CLOEXEC);
+
+			if (fd == -1) {
+				results[i] = -errno;
+				continue;
+			}
+
+			ssize_t r = -1;
+			do {
+				r = read(fd, slot(i), slot_size());
+			} while (r < 0 && errno == EINTR);
+
+			results[i] = (r >= 0) ? static_cast<int>(r) : -errno;
+			close(fd);
+		}
+	}
+
+	// content of each file (nullopt when it can't be read or it's bigger than limit), there can be
+	// at most `opts.batch` paths and content is valid until next call, each file is read with a single
+	// request, so content is accepted only when its length is same as expected size (short reads
+	// happen on network filesystems, FUSE or after signal) and other files are left to streaming path
+	auto load(std::span<const std::string> paths, std::span<const uint64_t> sizes) -> std::vector<std::optional<std::span<const std::byte>>> {
+		if (!usable || !load_with_uring(paths)) {
+			load_with_syscalls(paths);
+		}
+
+		std::vector<std::optional<std::span<const std::byte>>> output(paths.size());
+
+		for (size_t i = 0; i != paths.size(); ++i) {
+			if (results[i] >= 0 && static_cast<uint64_t>(results[i]) == sizes[i] && static_cast<size_t>(results[i]) <= opts.max_size) {
+				output[i] = std::span<const std::byte>(slot(i), static_cast<size_t>(results[i]));
+			}
+		}
+
+		return output;
+	}
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef CTHASH_SHASUM_SPARSE_HPP
+#define CTHASH_SHASUM_SPARSE_HPP
+
+#include <algorithm>
+#include <span>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+// regular file is read by its data segments (SEEK_DATA / SEEK_HOLE), holes are given to `hole` callback
+// only by their length, filesystems without support for it report whole file as data
+template <typename Data, typename Hole> bool read_sparse(int fd, uint64_t size, Data && data, Hole && hole) {
+	constexpr size_t buffer_size = 4u * 1024u * 1024u;
+
+	std::vector<std::byte> buffer(static_cast<size_t>(std::min<uint64_t>(size, buffer_size)));
+
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+	for (uint64_t offset = 0; offset < size;) {
+		uint64_t begin = offset;
+		uint64_t end = size;
+
+		const off_t d = lseek(fd, static_cast<off_t>(offset), SEEK_DATA);
+
+		if (d >= 0) {
+			begin = std::min<uint64_t>(static_cast<uint64_t>(d), size);
+			const off_t h = lseek(fd, static_cast<off_t>(begin), SEEK_HOLE);
+			end = (h > d) ? std::min<uint64_t>(static_cast<uint64_t>(h), size) : size;
+		} else if (errno == ENXIO) {
+			// rest of the file is a hole
+			begin = size;
+		}
+
+		if (begin != offset) {
+			hole(begin - offset);
+		}
+
+		for (offset = begin; offset < end;) {
+			const size_t n = static_cast<size_t>(std::min<uint64_t>(buffer.size(), end - offset));
+			const ssize_t r = pread(fd, buffer.data(), n, static_cast<off_t>(offset));
+
+			if (r < 0 && errno == EINTR) {
+				continue;
+			}
+
+			// file was truncated while reading
+			if (r <= 0) {
+				return false;
+			}
+
+			data(std::span<const std::byte>(buffer.data(), static_cast<size_t>(r)));
+			offset += static_cast<uint64_t>(r);
+		}
+	}
+
+	return true;
+}
+
+#endif
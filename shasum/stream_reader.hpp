@@ -0,0 +1,266 @@
+#ifndef CTHASH_SHASUM_STREAM_READER_HPP
+#define CTHASH_SHASUM_STREAM_READER_HPP
+
+#include "uring.hpp"
+#include <atomic>
+#include <memory>
+#include <semaphore>
+#include <span>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// streaming reader for files which shouldn't be mapped (larger than memory, block devices, network filesystems),
+// file is read into a ring of aligned buffers while previous buffers are hashed, and already hashed part
+// is dropped from page cache
+
+struct stream_options {
+	size_t buffer_size{4u * 1024u * 1024u}; // must be multiple of `alignment`
+	unsigned buffers{4u};
+	bool direct{false};		// O_DIRECT (bypass page cache completely)
+	bool drop_cache{true};	// POSIX_FADV_DONTNEED behind cursor
+	bool use_uring{true};	// otherwise a thread with pread is used
+};
+
+struct aligned_buffer {
+	static constexpr size_t alignment = 4096u;
+
+	struct deleter {
+		void operator()(std::byte * ptr) const noexcept {
+			std::free(ptr);
+		}
+	};
+
+	std::unique_ptr<std::byte, deleter> ptr{};
+	size_t size{0};
+
+	explicit aligned_buffer(size_t sz): ptr{static_cast<std::byte *>(std::aligned_alloc(alignment, (sz + alignment - 1u) / alignment * alignment))}, size{sz} { }
+
+	std::byte * data() const noexcept {
+		return ptr.get();
+	}
+};
+
+// open file for streaming (O_DIRECT is silently dropped when filesystem doesn't support it)
+inline int open_for_streaming(const char * path, bool direct) {
+	if (direct) {
+		if (const int fd = open(path, O_RDONLY | O_DIRECT); fd != -1) {
+			return fd;
+		}
+	}
+	return open(path, O_RDONLY);
+}
+
+namespace stream_detail {
+
+// short read can happen (signals, network filesystems), rest of the buffer is read synchronously, under
+// O_DIRECT position and length must stay aligned, so reading continues from start of the last partial block
+// (buffer must have space for `expected` rounded up to alignment)
+inline bool complete_read(int fd, std::byte * buffer, size_t done, size_t expected, uint64_t offset) {
+	if (done >= expected) {
+		return true;
+	}
+
+	const int flags = fcntl(fd, F_GETFL);
+	const size_t block = (flags != -1 && (flags & O_DIRECT) != 0) ? aligned_buffer::alignment : 1u;
+	const size_t end = (expected + block - 1u) / block * block;
+
+	while (done < expected) {
+		const size_t from = done / block * block;
+		const ssize_t r = pread(fd, buffer + from, end - from, static_cast<off_t>(offset + from));
+		if (r < 0 && errno == EINTR) {
+			continue;
+		}
+		if (r <= 0 || from + static_cast<size_t>(r) <= done) {
+			return false;
+		}
+		done = from + static_cast<size_t>(r);
+	}
+	return true;
+}
+
+inline void drop_behind(int fd, const stream_options & opts, uint64_t offset, size_t length) {
+	if (opts.drop_cache && !opts.direct) {
+		posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_DONTNEED);
+	}
+}
+
+template <typename Fn> bool stream_with_uring(uring_queue & ring, int fd, uint64_t size, std::span<aligned_buffer> buffers, const stream_options & opts, Fn && callback) {
+	const size_t count = buffers.size();
+	std::vector<int> results(count);
+	std::vector<bool> ready(count);
+
+	uint64_t submitted = 0; // offset of next read
+	uint64_t consumed = 0;	// offset of next buffer given to callback
+	size_t in_flight = 0;
+
+	const auto submit = [&](size_t slot) {
+		ready[slot] = false;
+		const bool ok = ring.submit_read(fd, buffers[slot].data(), static_cast<unsigned>(opts.buffer_size), submitted, slot);
+		submitted += opts.buffer_size;
+		in_flight += ok;
+		return ok;
+	};
+
+	bool success = true;
+
+	// fill the whole ring
+	for (size_t slot = 0; success && slot != count && submitted < size; ++slot) {
+		success = submit(slot);
+	}
+
+	for (size_t slot = 0; success && consumed < size; slot = (slot + 1u) % count) {
+		// completions can come in any order
+		while (!ready[slot]) {
+			io_uring_cqe cqe{};
+			if (!ring.wait(cqe)) {
+				success = false;
+				break;
+			}
+			--in_flight;
+			results[cqe.user_data] = cqe.res;
+			ready[cqe.user_data] = true;
+		}
+
+		if (!success) {
+			break;
+		}
+
+		const size_t expected = static_cast<size_t>(std::min<uint64_t>(opts.buffer_size, size - consumed));
+
+		if (results[slot] < 0 || !complete_read(fd, buffers[slot].data(), static_cast<size_t>(results[slot]), expected, consumed)) {
+			success = false;
+			break;
+		}
+
+		callback(std::span<const std::byte>(buffers[slot].data(), expected));
+		drop_behind(fd, opts, consumed, expected);
+		consumed += expected;
+
+		if (submitted < size && !submit(slot)) {
+			success = false;
+			break;
+		}
+	}
+
+	// buffers can't be released while kernel is still writing into them
+	while (in_flight != 0u) {
+		io_uring_cqe cqe{};
+		if (!ring.wait(cqe)) {
+			break;
+		}
+		--in_flight;
+	}
+
+	return success;
+}
+
+// reader thread fills the ring with pread, caller hashes what's ready
+template <typename Fn> bool stream_with_pread(int fd, uint64_t size, std::span<aligned_buffer> buffers, const stream_options & opts, Fn && callback) {
+	const size_t count = buffers.size();
+	std::vector<ssize_t> results(count);
+
+	std::counting_semaphore<> empty(static_cast<std::ptrdiff_t>(count));
+	std::counting_semaphore<> full(0);
+	std::atomic<bool> cancelled{false};
+
+	auto reader = std::jthread([&] {
+		uint64_t offset = 0;
+		for (size_t slot = 0; offset < size; slot = (slot + 1u) % count) {
+			empty.acquire();
+
+			if (cancelled) {
+				return;
+			}
+
+			// always whole aligned buffer is requested (O_DIRECT), at the end it's shortened by kernel
+			const size_t expected = static_cast<size_t>(std::min<uint64_t>(opts.buffer_size, size - offset));
+			ssize_t r = -1;
+			do {
+				r = pread(fd, buffers[slot].data(), opts.buffer_size, static_cast<off_t>(offset));
+			} while (r < 0 && errno == EINTR);
+
+			const bool ok = r >= 0 && complete_read(fd, buffers[slot].data(), static_cast<size_t>(r), expected, offset);
+			results[slot] = ok ? static_cast<ssize_t>(expected) : -1;
+			offset += expected;
+
+			full.release();
+
+			if (!ok) {
+				return;
+			}
+		}
+	});
+
+	bool success = true;
+	uint64_t consumed = 0;
+
+	for (size_t slot = 0; consumed < size; slot = (slot + 1u) % count) {
+		full.acquire();
+
+		if (results[slot] < 0) {
+			success = false;
+			break;
+		}
+
+		const auto length = static_cast<size_t>(results[slot]);
+		callback(std::span<const std::byte>(buffers[slot].data(), length));
+		drop_behind(fd, opts, consumed, length);
+		consumed += length;
+
+		empty.release();
+	}
+
+	if (!success) {
+		cancelled = true;
+		empty.release();
+	}
+
+	return success;
+}
+
+// IORING_OP_READ is available since Linux 5.6, older kernels use the pread thread
+inline bool uring_read_supported() {
+	static const bool supported = [] {
+		uring_queue ring(1u);
+		return ring.valid() && ring.supports(IORING_OP_READ);
+	}();
+	return supported;
+}
+
+} // namespace stream_detail
+
+// read `size` bytes from beginning of `fd` and give them to callback in order
+template <typename Fn> bool stream_file(int fd, uint64_t size, const stream_options & opts, Fn && callback) {
+	if (size == 0u) {
+		return true;
+	}
+
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+	std::vector<aligned_buffer> buffers;
+	const unsigned count = std::max(opts.buffers, 2u);
+	for (unsigned i = 0; i != count; ++i) {
+		buffers.emplace_back(opts.buffer_size);
+		if (buffers.back().data() == nullptr) {
+			return false;
+		}
+	}
+
+	if (opts.use_uring && stream_detail::uring_read_supported()) {
+		uring_queue ring(count);
+		if (ring.valid()) {
+			return stream_detail::stream_with_uring(ring, fd, size, buffers, opts, callback);
+		}
+	}
+
+	return stream_detail::stream_with_pread(fd, size, buffers, opts, callback);
+}
+
+#endif
@@ -0,0 +1,350 @@
+#ifndef CTHASH_SHASUM_TAR_HPP
+#define CTHASH_SHASUM_TAR_HPP
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+// incremental parser of ustar / pax (and GNU long name) archives, input is given in chunks of any size
+// and payload of each member is passed to callback in place (without copying or seeking), so it can
+// be used on pipes
+
+struct tar_member {
+	std::string path;
+	uint64_t size{0};
+	char type{'0'};
+
+	bool regular() const noexcept {
+		return type == '0' || type == '\0' || type == '7';
+	}
+};
+
+namespace tar_detail {
+
+static constexpr size_t block_size = 512u;
+
+inline auto field(std::span<const std::byte, block_size> header, size_t offset, size_t length) -> std::string_view {
+	const auto * ptr = reinterpret_cast<const char *>(header.data()) + offset;
+	return std::string_view(ptr, std::find(ptr, ptr + length, '\0'));
+}
+
+// octal number terminated by space or NUL, or big-endian binary number when high bit is set (GNU)
+inline auto parse_number(std::span<const std::byte, block_size> header, size_t offset, size_t length) -> std::optional<uint64_t> {
+	const auto bytes = header.subspan(offset, length);
+
+	if ((std::to_integer<unsigned>(bytes[0]) & 0x80u) != 0u) {
+		uint64_t value = std::to_integer<unsigned>(bytes[0]) & 0x7Fu;
+		for (std::byte b: bytes.subspan(1)) {
+			if (value >> 56u) {
+				return std::nullopt;
+			}
+			value = (value << 8u) | std::to_integer<unsigned>(b);
+		}
+		return value;
+	}
+
+	auto text = field(header, offset, length);
+
+	while (!text.empty() && text.front() == ' ') {
+		text.remove_prefix(1);
+	}
+	while (!text.empty() && text.back() == ' ') {
+		text.remove_suffix(1);
+	}
+
+	uint64_t value = 0;
+
+	if (text.empty()) {
+		return value;
+	}
+
+	const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value, 8);
+
+	if (ec != std::errc{} || ptr != text.data() + text.size()) {
+		return std::nullopt;
+	}
+
+	return value;
+}
+
+// checksum is computed with its own field filled with spaces
+inline bool valid_checksum(std::span<const std::byte, block_size> header) {
+	const auto expected = parse_number(header, 148u, 8u);
+
+	if (!expected) {
+		return false;
+	}
+
+	uint64_t sum = 0;
+	for (size_t i = 0; i != block_size; ++i) {
+		sum += (i >= 148u && i < 156u) ? uint64_t{' '} : std::to_integer<uint64_t>(header[i]);
+	}
+
+	return sum == *expected;
+}
+
+inline bool is_zero(std::span<const std::byte, block_size> header) {
+	return std::all_of(header.begin(), header.end(), [](std::byte b) { return b == std::byte{0}; });
+}
+
+inline uint64_t padding(uint64_t size) noexcept {
+	return (block_size - size % block_size) % block_size;
+}
+
+} // namespace tar_detail
+
+// pax records are `<length> <key>=<value>\n`
+template <typename Fn> bool parse_pax_records(std::string_view data, Fn && record) {
+	while (!data.empty()) {
+		const auto space = data.find(' ');
+		size_t length = 0;
+
+		if (space == std::string_view::npos || std::from_chars(data.data(), data.data() + space, length).ptr != data.data() + space) {
+			return false;
+		}
+
+		if (length <= space + 1u || length > data.size() || data[length - 1u] != '\n') {
+			return false;
+		}
+
+		const auto content = data.substr(space + 1u, length - space - 2u);
+		const auto eq = content.find('=');
+
+		if (eq == std::string_view::npos) {
+			return false;
+		}
+
+		record(content.substr(0, eq), content.substr(eq + 1u));
+		data.remove_prefix(length);
+	}
+
+	return true;
+}
+
+// callbacks: `begin(member)`, `data(span)` with payload of regular members and `end(member)`
+template <typename Begin, typename Data, typename End> struct tar_parser {
+	enum class state { header, extended, payload, padding, finished, failed };
+
+	static constexpr uint64_t max_extended_size = 1024u * 1024u;
+
+	Begin begin;
+	Data data;
+	End end;
+
+	state current{state::header};
+	std::array<std::byte, tar_detail::block_size> header{};
+	size_t header_used{0};
+
+	uint64_t remaining{0}; // in payload, extended header or padding
+	uint64_t padding_after{0};
+	char extended_type{0};
+	std::string extended{};
+
+	// overrides from pax (or GNU long name) headers for next member
+	std::optional<std::string> next_path{};
+	std::optional<uint64_t> next_size{};
+
+	size_t zero_blocks{0};
+	tar_member member{};
+
+	bool failed() const noexcept {
+		return current == state::failed;
+	}
+
+	// two zero blocks are the end (trailing bytes of last record are ignored)
+	bool finished() const noexcept {
+		return current == state::finished;
+	}
+
+	// member is split by end of input
+	bool complete() const noexcept {
+		return current == state::finished || (current == state::header && header_used == 0u && next_path == std::nullopt && next_size == std::nullopt);
+	}
+
+	void feed(std::span<const std::byte> input) {
+		while (!input.empty()) {
+			switch (current) {
+			case state::header: {
+				const size_t n = std::min(input.size(), header.size() - header_used);
+				std::copy_n(input.begin(), n, header.begin() + static_cast<std::ptrdiff_t>(header_used));
+				header_used += n;
+				input = input.subspan(n);
+
+				if (header_used == header.size()) {
+					header_used = 0;
+					process_header();
+				}
+				break;
+			}
+			case state::extended: {
+				const size_t n = static_cast<size_t>(std::min<uint64_t>(input.size(), remaining));
+				extended.append(reinterpret_cast<const char *>(input.data()), n);
+				input = input.subspan(n);
+				remaining -= n;
+
+				if (remaining == 0u) {
+					process_extended();
+				}
+				break;
+			}
+			case state::payload: {
+				const size_t n = static_cast<size_t>(std::min<uint64_t>(input.size(), remaining));
+
+				if (member.regular()) {
+					data(input.first(n));
+				}
+
+				input = input.subspan(n);
+				remaining -= n;
+
+				if (remaining == 0u) {
+					finish_member();
+				}
+				break;
+			}
+			case state::padding: {
+				const size_t n = static_cast<size_t>(std::min<uint64_t>(input.size(), remaining));
+				input = input.subspan(n);
+				remaining -= n;
+
+				if (remaining == 0u) {
+					current = state::header;
+				}
+				break;
+			}
+			case state::finished:
+			case state::failed:
+				return;
+			}
+		}
+	}
+
+private:
+	void skip_padding(uint64_t size) {
+		remaining = tar_detail::padding(size);
+		current = (remaining != 0u) ? state::padding : state::header;
+	}
+
+	void process_header() {
+		const auto block = std::span<const std::byte, tar_detail::block_size>(header);
+
+		if (tar_detail::is_zero(block)) {
+			current = (++zero_blocks == 2u) ? state::finished : state::header;
+			return;
+		}
+
+		zero_blocks = 0;
+
+		const auto size = tar_detail::parse_number(block, 124u, 12u);
+
+		if (!tar_detail::valid_checksum(block) || !size) {
+			current = state::failed;
+			return;
+		}
+
+		const char type = static_cast<char>(header[156]);
+
+		// metadata for following member
+		if (type == 'x' || type == 'g' || type == 'L' || type == 'K') {
+			if (*size > max_extended_size) {
+				current = state::failed;
+				return;
+			}
+
+			extended_type = type;
+			extended.clear();
+			remaining = *size;
+			padding_after = tar_detail::padding(*size);
+
+			if (remaining == 0u) {
+				process_extended();
+			} else {
+				current = state::extended;
+			}
+			return;
+		}
+
+		member = tar_member{};
+		member.type = type;
+		member.size = next_size.value_or(*size);
+
+		if (next_path) {
+			member.path = std::move(*next_path);
+		} else {
+			const auto name = tar_detail::field(block, 0u, 100u);
+			const auto prefix = tar_detail::field(block, 345u, 155u);
+			const bool ustar = tar_detail::field(block, 257u, 5u) == "ustar";
+
+			member.path = (ustar && !prefix.empty()) ? std::string(prefix) + "/" + std::string(name) : std::string(name);
+		}
+
+		next_path.reset();
+		next_size.reset();
+
+		// hard links, symbolic links, directories and devices have no payload
+		if (type == '1' || type == '2' || type == '3' || type == '4' || type == '5' || type == '6') {
+			member.size = 0u;
+		}
+
+		begin(std::as_const(member));
+
+		remaining = member.size;
+
+		if (remaining == 0u) {
+			finish_member();
+		} else {
+			current = state::payload;
+		}
+	}
+
+	void process_extended() {
+		if (extended_type == 'L') {
+			// GNU long name is NUL terminated
+			next_path = std::string(extended.c_str());
+		} else if (extended_type == 'K') {
+			// link target is not interesting
+		} else {
+			// records of global header ('g') can't name or size a member, they are only validated
+			const bool global = extended_type == 'g';
+
+			const bool valid = parse_pax_records(extended, [&](std::string_view key, std::string_view value) {
+				if (global) {
+					return;
+				}
+
+				if (key == "path") {
+					next_path = std::string(value);
+				} else if (key == "size") {
+					uint64_t size = 0;
+					if (std::from_chars(value.data(), value.data() + value.size(), size).ptr == value.data() + value.size()) {
+						next_size = size;
+					}
+				}
+			});
+
+			if (!valid) {
+				current = state::failed;
+				return;
+			}
+		}
+
+		remaining = padding_after;
+		current = (remaining != 0u) ? state::padding : state::header;
+	}
+
+	void finish_member() {
+		end(std::as_const(member));
+		skip_padding(member.size);
+	}
+};
+
+template <typename Begin, typename Data, typename End> tar_parser(Begin, Data, End) -> tar_parser<Begin, Data, End>;
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef CTHASH_SHASUM_TEE_HPP
+#define CTHASH_SHASUM_TEE_HPP
+
+#include "input.hpp"
+#include <algorithm>
+#include <span>
+#include <vector>
+#include <cstddef>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// copy input to output and hash it on the way, data is moved by kernel where possible:
+// - pipe to pipe: pages are duplicated with tee() into output, then read (once) for hashing
+// - file to pipe: file is mapped, hashed in place and the same pages are given to output with vmsplice()
+// - otherwise read() and write()
+
+namespace tee_detail {
+
+inline bool is_pipe(int fd) {
+	struct stat info {};
+	return fstat(fd, &info) == 0 && S_ISFIFO(info.st_mode);
+}
+
+inline bool is_regular(int fd) {
+	struct stat info {};
+	return fstat(fd, &info) == 0 && S_ISREG(info.st_mode);
+}
+
+inline bool write_all(int fd, std::span<const std::byte> data) {
+	while (!data.empty()) {
+		const ssize_t r = write(fd, data.data(), data.size());
+
+		if (r < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+
+		data = data.subspan(static_cast<size_t>(r));
+	}
+	return true;
+}
+
+inline bool read_exactly(int fd, std::span<std::byte> data) {
+	while (!data.empty()) {
+		const ssize_t r = read(fd, data.data(), data.size());
+
+		if (r < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if (r <= 0) {
+			return false;
+		}
+
+		data = data.subspan(static_cast<size_t>(r));
+	}
+	return true;
+}
+
+inline bool vmsplice_all(int fd, std::span<const std::byte> data) {
+	while (!data.empty()) {
+		iovec iov{const_cast<std::byte *>(data.data()), data.size()};
+		const ssize_t r = vmsplice(fd, &iov, 1u, 0u);
+
+		if (r < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+
+		data = data.subspan(static_cast<size_t>(r));
+	}
+	return true;
+}
+
+template <typename Fn> bool pipe_to_pipe(int in, int out, Fn && callback) {
+	std::vector<std::byte> buffer(static_cast<size_t>(std::max(fcntl(in, F_GETPIPE_SZ), 64 * 1024)));
+
+	for (;;) {
+		const ssize_t n = tee(in, out, buffer.size(), 0u);
+
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+
+		if (n == 0) {
+			return true;
+		}
+
+		// the same bytes are still in input pipe
+		const auto chunk = std::span<std::byte>(buffer).first(static_cast<size_t>(n));
+
+		if (!read_exactly(in, chunk)) {
+			return false;
+		}
+
+		callback(std::span<const std::byte>(chunk));
+	}
+}
+
+template <typename Fn> bool file_to_pipe(int in, int out, Fn && callback) {
+	struct stat info {};
+
+	if (fstat(in, &info) != 0) {
+		return false;
+	}
+
+	bool written = true;
+
+	// pages are referenced by pipe (not copied), so they stay valid after window is unmapped
+	const bool r = map_file(in, static_cast<uint64_t>(info.st_size), map_options{.prefetch = false}, [&](std::span<const std::byte> window) {
+		if (written) {
+			callback(window);
+			written = vmsplice_all(out, window);
+		}
+	});
+
+	return r && written;
+}
+
+template <typename Fn> bool copy(int in, int out, Fn && callback) {
+	bool written = true;
+
+	const bool r = read_stream(in, [&](std::span<const std::byte> chunk) {
+		callback(chunk);
+		written = written && write_all(out, chunk);
+	});
+
+	return r && written;
+}
+
+} // namespace tee_detail
+
+template <typename Fn> bool tee_stream(int in, int out, Fn && callback) {
+	if (tee_detail::is_pipe(out)) {
+#ifdef F_SETPIPE_SZ
+		fcntl(out, F_SETPIPE_SZ, 1024 * 1024);
+#endif
+
+		if (tee_detail::is_pipe(in)) {
+#ifdef F_SETPIPE_SZ
+			fcntl(in, F_SETPIPE_SZ, 1024 * 1024);
+#endif
+			return tee_detail::pipe_to_pipe(in, out, callback);
+		}
+
+		// mapping starts at beginning of file, so only input which wasn't partially read yet
+		if (tee_detail::is_regular(in) && lseek(in, 0, SEEK_CUR) == 0) {
+			return tee_detail::file_to_pipe(in, out, callback);
+		}
+	}
+
+	return tee_detail::copy(in, out, callback);
+}
+
+#endif
@@ -0,0 +1,265 @@
+#ifndef CTHASH_SHASUM_TREE_HPP
+#define CTHASH_SHASUM_TREE_HPP
+
+#include "manifest.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+
+// regular file found in directory tree (path is relative to root of the tree)
+struct tree_file {
+	std::string path;
+	uint64_t size{0};
+	uint64_t device{0};
+	uint64_t inode{0};
+};
+
+struct tree_listing {
+	std::vector<tree_file> files;
+	std::vector<std::string> directories; // without root itself
+	size_t skipped{0}; // symlinks, devices, sockets, ...
+	std::vector<std::string> errors;
+};
+
+// directories are scanned in parallel with getdents64 and statx (only when type is not known from getdents)
+struct tree_walker {
+	struct linux_dirent64 {
+		uint64_t d_ino;
+		int64_t d_off;
+		unsigned short d_reclen;
+		unsigned char d_type;
+		char d_name[1];
+	};
+
+	std::string root;
+
+	std::mutex lock;
+	std::condition_variable wakeup;
+	std::vector<std::string> pending{}; // relative paths of directories
+	size_t busy{0};
+
+	tree_listing output{};
+
+	explicit tree_walker(std::string r): root{std::move(r)} {
+		while (root.size() > 1u && root.back() == '/') {
+			root.pop_back();
+		}
+	}
+
+	static std::string join(std::string_view dir, std::string_view name) {
+		if (dir.empty()) {
+			return std::string(name);
+		}
+
+		std::string r;
+		r.reserve(dir.size() + 1u + name.size());
+		r.append(dir).append("/").append(name);
+		return r;
+	}
+
+	std::string full_path(std::string_view relative) const {
+		return relative.empty() ? root : root + "/" + std::string(relative);
+	}
+
+	void scan(const std::string & dir, std::vector<std::string> & dirs, tree_listing & local) {
+		const int fd = open(full_path(dir).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+		if (fd == -1) {
+			local.errors.push_back(full_path(dir));
+			return;
+		}
+
+		alignas(linux_dirent64) std::byte buffer[64u * 1024u];
+
+		for (;;) {
+			const long n = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+
+			if (n < 0) {
+				local.errors.push_back(full_path(dir));
+				break;
+			}
+
+			if (n == 0) {
+				break;
+			}
+
+			for (long offset = 0; offset < n;) {
+				const auto * entry = reinterpret_cast<const linux_dirent64 *>(buffer + offset);
+				offset += entry->d_reclen;
+
+				const auto name = std::string_view(entry->d_name);
+
+				if (name == "." || name == "..") {
+					continue;
+				}
+
+				unsigned char type = entry->d_type;
+				uint64_t size = 0;
+				uint64_t device = 0;
+				uint64_t inode = 0;
+
+				// size is needed for scheduling, for unknown types statx tells us the type too
+				if (type == DT_REG || type == DT_UNKNOWN) {
+					struct statx info {};
+					if (statx(fd, entry->d_name, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC, STATX_TYPE | STATX_SIZE | STATX_INO, &info) != 0) {
+						local.errors.push_back(full_path(join(dir, name)));
+						continue;
+					}
+
+					type = S_ISREG(info.stx_mode) ? DT_REG : (S_ISDIR(info.stx_mode) ? DT_DIR : DT_UNKNOWN);
+					size = info.stx_size;
+					device = makedev(info.stx_dev_major, info.stx_dev_minor);
+					inode = info.stx_ino;
+				}
+
+				if (type == DT_DIR) {
+					dirs.push_back(join(dir, name));
+				} else if (type == DT_REG) {
+					local.files.push_back(tree_file{join(dir, name), size, device, inode});
+				} else {
+					++local.skipped;
+				}
+			}
+		}
+
+		close(fd);
+	}
+
+	void work() {
+		std::vector<std::string> dirs;
+		tree_listing local;
+
+		auto guard = std::unique_lock{lock};
+
+		for (;;) {
+			wakeup.wait(guard, [&] { return !pending.empty() || busy == 0u; });
+
+			if (pending.empty()) {
+				return;
+			}
+
+			const std::string dir = std::move(pending.back());
+			pending.pop_back();
+			++busy;
+
+			guard.unlock();
+			scan(dir, dirs, local);
+			guard.lock();
+
+			output.directories.insert(output.directories.end(), dirs.begin(), dirs.end());
+			std::move(dirs.begin(), dirs.end(), std::back_inserter(pending));
+			std::move(local.files.begin(), local.files.end(), std::back_inserter(output.files));
+			std::move(local.errors.begin(), local.errors.end(), std::back_inserter(output.errors));
+			output.skipped += local.skipped;
+
+			dirs.clear();
+			local = tree_listing{};
+			--busy;
+			wakeup.notify_all();
+		}
+	}
+
+	// files are sorted by path (byte-wise) so output is deterministic
+	tree_listing run(unsigned threads) {
+		pending.push_back(std::string{});
+
+		{
+			std::vector<std::jthread> workers;
+			for (unsigned i = 1; i < threads; ++i) {
+				workers.emplace_back([this] { work(); });
+			}
+			work();
+		}
+
+		std::sort(output.files.begin(), output.files.end(), [](const tree_file & lhs, const tree_file & rhs) { return lhs.path < rhs.path; });
+		return std::move(output);
+	}
+};
+
+// GNU tools escape backslash and newline and mark such line with backslash
+inline std::string manifest_line(const digest & d, std::string_view path) {
+	const bool escape = path.find_first_of("\\\n") != std::string_view::npos;
+
+	std::string line;
+	line.reserve(d.length * 2u + path.size() + 4u);
+
+	if (escape) {
+		line.push_back('\\');
+	}
+
+	const size_t hex_start = line.size();
+	line.resize(hex_start + d.length * 2u);
+	cthash::internal::encode_hexdec(d.view(), line.data() + hex_start);
+
+	line.append("  ");
+
+	for (char c: path) {
+		if (escape && c == '\\') {
+			line.append("\\\\");
+		} else if (escape && c == '\n') {
+			line.append("\\n");
+		} else {
+			line.push_back(c);
+		}
+	}
+
+	line.push_back('\n');
+	return line;
+}
+
+enum class tree_change { added, removed, modified };
+
+// both manifests are sorted by path (unsorted are sorted first), then merged in linear time
+template <typename Fn> size_t diff_manifests(std::vector<manifest_entry> lhs, std::vector<manifest_entry> rhs, Fn && report) {
+	const auto by_path = [](const manifest_entry & a, const manifest_entry & b) { return a.path < b.path; };
+
+	for (auto * entries: {&lhs, &rhs}) {
+		if (!std::is_sorted(entries->begin(), entries->end(), by_path)) {
+			std::sort(entries->begin(), entries->end(), by_path);
+		}
+	}
+
+	const auto same = [](const manifest_entry & a, const manifest_entry & b) {
+		const auto x = a.expected.view();
+		const auto y = b.expected.view();
+		return a.algo == b.algo && std::equal(x.begin(), x.end(), y.begin(), y.end());
+	};
+
+	size_t changes = 0;
+	auto l = lhs.begin();
+	auto r = rhs.begin();
+
+	while (l != lhs.end() || r != rhs.end()) {
+		if (r == rhs.end() || (l != lhs.end() && l->path < r->path)) {
+			report(tree_change::removed, l->path);
+			++l;
+			++changes;
+		} else if (l == lhs.end() || r->path < l->path) {
+			report(tree_change::added, r->path);
+			++r;
+			++changes;
+		} else {
+			if (!same(*l, *r)) {
+				report(tree_change::modified, l->path);
+				++changes;
+			}
+			++l;
+			++r;
+		}
+	}
+
+	return changes;
+}
+
+#endif
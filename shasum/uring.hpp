@@ -0,0 +1,163 @@
+#ifndef CTHASH_SHASUM_URING_HPP
+#define CTHASH_SHASUM_URING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cerrno>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// minimal io_uring wrapper directly over syscalls (liburing is not needed)
+struct uring_queue {
+	int fd{-1};
+	io_uring_params params{};
+
+	void * sq_ring{MAP_FAILED};
+	size_t sq_ring_size{0};
+	void * cq_ring{MAP_FAILED};
+	size_t cq_ring_size{0};
+	io_uring_sqe * sqes{static_cast<io_uring_sqe *>(MAP_FAILED)};
+	size_t sqes_size{0};
+
+	unsigned prepared{0};
+
+	explicit uring_queue(unsigned entries) {
+		fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+
+		if (fd < 0) {
+			fd = -1;
+			return;
+		}
+
+		sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+		sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+		cq_ring = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+		sqes = static_cast<io_uring_sqe *>(mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+	}
+
+	uring_queue(const uring_queue &) = delete;
+	uring_queue(uring_queue &&) = delete;
+
+	~uring_queue() {
+		if (sqes != MAP_FAILED) {
+			munmap(sqes, sqes_size);
+		}
+		if (cq_ring != MAP_FAILED) {
+			munmap(cq_ring, cq_ring_size);
+		}
+		if (sq_ring != MAP_FAILED) {
+			munmap(sq_ring, sq_ring_size);
+		}
+		if (fd != -1) {
+			close(fd);
+		}
+	}
+
+	bool valid() const noexcept {
+		return fd != -1 && sq_ring != MAP_FAILED && cq_ring != MAP_FAILED && sqes != MAP_FAILED;
+	}
+
+	unsigned & sq_field(uint32_t offset) const noexcept {
+		return *reinterpret_cast<unsigned *>(static_cast<std::byte *>(sq_ring) + offset);
+	}
+
+	unsigned & cq_field(uint32_t offset) const noexcept {
+		return *reinterpret_cast<unsigned *>(static_cast<std::byte *>(cq_ring) + offset);
+	}
+
+	// opcodes are probed as older kernels reject unknown ones only when they are submitted
+	bool supports(uint8_t opcode) const {
+		constexpr unsigned max_ops = 256u;
+		alignas(io_uring_probe) std::byte storage[sizeof(io_uring_probe) + max_ops * sizeof(io_uring_probe_op)]{};
+		auto * probe = reinterpret_cast<io_uring_probe *>(storage);
+
+		if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, max_ops) < 0) {
+			return false;
+		}
+
+		return opcode < probe->ops_len && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) != 0u;
+	}
+
+	// entry is only prepared, it's given to kernel by `submit`
+	io_uring_sqe * push() noexcept {
+		const unsigned head = std::atomic_ref<unsigned>(sq_field(params.sq_off.head)).load(std::memory_order_acquire);
+		const unsigned tail = sq_field(params.sq_off.tail);
+
+		if (tail - head == params.sq_entries) {
+			return nullptr;
+		}
+
+		const unsigned index = tail & sq_field(params.sq_off.ring_mask);
+
+		io_uring_sqe * sqe = &sqes[index];
+		*sqe = io_uring_sqe{};
+
+		(&sq_field(params.sq_off.array))[index] = index;
+		std::atomic_ref<unsigned>(sq_field(params.sq_off.tail)).store(tail + 1u, std::memory_order_release);
+		++prepared;
+		return sqe;
+	}
+
+	// entries which were not given to kernel yet are dropped (kernel reads tail only in `submit`)
+	void discard() noexcept {
+		std::atomic_ref<unsigned>(sq_field(params.sq_off.tail)).store(sq_field(params.sq_off.tail) - prepared, std::memory_order_release);
+		prepared = 0u;
+	}
+
+	bool submit() {
+		while (prepared != 0u) {
+			const long r = syscall(__NR_io_uring_enter, fd, prepared, 0u, 0u, nullptr, 0u);
+
+			if (r < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return false;
+			}
+
+			prepared -= static_cast<unsigned>(r);
+		}
+		return true;
+	}
+
+	bool submit_read(int file, std::byte * buffer, unsigned length, uint64_t offset, uint64_t user_data) {
+		io_uring_sqe * sqe = push();
+
+		if (sqe == nullptr) {
+			return false;
+		}
+
+		sqe->opcode = IORING_OP_READ;
+		sqe->fd = file;
+		sqe->addr = reinterpret_cast<uint64_t>(buffer);
+		sqe->len = length;
+		sqe->off = offset;
+		sqe->user_data = user_data;
+
+		return submit();
+	}
+
+	bool wait(io_uring_cqe & out) {
+		const unsigned head = cq_field(params.cq_off.head);
+
+		while (std::atomic_ref<unsigned>(cq_field(params.cq_off.tail)).load(std::memory_order_acquire) == head) {
+			const long r = syscall(__NR_io_uring_enter, fd, 0u, 1u, IORING_ENTER_GETEVENTS, nullptr, 0u);
+			if (r < 0 && errno != EINTR) {
+				return false;
+			}
+		}
+
+		const auto * cqes = reinterpret_cast<const io_uring_cqe *>(static_cast<std::byte *>(cq_ring) + params.cq_off.cqes);
+		out = cqes[head & cq_field(params.cq_off.ring_mask)];
+		std::atomic_ref<unsigned>(cq_field(params.cq_off.head)).store(head + 1u, std::memory_order_release);
+		return true;
+	}
+};
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef CTHASH_SHASUM_WATCH_HPP
+#define CTHASH_SHASUM_WATCH_HPP
+
+#include "tree.hpp"
+#include <chrono>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// watch directory tree with inotify and report files which were changed, changes are reported
+// only after the file is quiet for a while (so it's not hashed while still being written)
+struct tree_watch {
+	static constexpr uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ATTRIB | IN_ONLYDIR;
+
+	using clock = std::chrono::steady_clock;
+
+	std::string root;
+	int fd{-1};
+	std::unordered_map<int, std::string> directories{}; // watch descriptor => relative path
+	std::map<std::string, clock::time_point> pending{};	// relative path => time of last event
+	clock::duration quiet{std::chrono::seconds(3)};
+
+	explicit tree_watch(std::string r): root{std::move(r)}, fd{inotify_init1(IN_CLOEXEC)} { }
+
+	tree_watch(const tree_watch &) = delete;
+	tree_watch(tree_watch &&) = delete;
+
+	~tree_watch() {
+		if (fd != -1) {
+			close(fd);
+		}
+	}
+
+	bool valid() const noexcept {
+		return fd != -1;
+	}
+
+	std::string full_path(std::string_view relative) const {
+		return relative.empty() ? root : root + "/" + std::string(relative);
+	}
+
+	bool add(const std::string & relative) {
+		// IN_ONLYDIR is part of mask only for adding (events don't use it)
+		const int wd = inotify_add_watch(fd, full_path(relative).c_str(), mask);
+
+		if (wd == -1) {
+			return false;
+		}
+
+		directories[wd] = relative;
+		return true;
+	}
+
+	// new directory can already contain files (created before watch was added)
+	void add_tree(const std::string & relative, unsigned threads) {
+		auto walker = tree_walker(full_path(relative));
+		const auto listing = walker.run(threads);
+
+		add(relative);
+		for (const auto & dir: listing.directories) {
+			add(tree_walker::join(relative, dir));
+		}
+
+		const auto now = clock::now();
+		for (const auto & file: listing.files) {
+			pending[tree_walker::join(relative, file.path)] = now;
+		}
+	}
+
+	void read_events(unsigned threads) {
+		alignas(inotify_event) char buffer[64u * 1024u];
+
+		const ssize_t n = read(fd, buffer, sizeof(buffer));
+
+		if (n <= 0) {
+			return;
+		}
+
+		const auto now = clock::now();
+
+		for (ssize_t offset = 0; offset < n;) {
+			const auto * event = reinterpret_cast<const inotify_event *>(buffer + offset);
+			offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+			if (event->mask & IN_IGNORED) {
+				directories.erase(event->wd);
+				continue;
+			}
+
+			const auto dir = directories.find(event->wd);
+
+			if (dir == directories.end() || event->len == 0u) {
+				continue;
+			}
+
+			const auto path = tree_walker::join(dir->second, event->name);
+
+			if (event->mask & IN_ISDIR) {
+				if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+					add_tree(path, threads);
+				}
+			} else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO | IN_ATTRIB)) {
+				pending[path] = now;
+			}
+		}
+	}
+
+	// runs until watch is broken, `changed` gets relative path of changed file
+	template <typename Fn> void run(unsigned threads, Fn && changed) {
+		for (;;) {
+			pollfd p{fd, POLLIN, 0};
+			const int r = poll(&p, 1, 1000);
+
+			if (r < 0 && errno != EINTR) {
+				return;
+			}
+
+			if (r > 0) {
+				read_events(threads);
+			}
+
+			const auto now = clock::now();
+
+			for (auto it = pending.begin(); it != pending.end();) {
+				if (now - it->second >= quiet) {
+					changed(it->first);
+					it = pending.erase(it);
+				} else {
+					++it;
+				}
+			}
+
+			if (directories.empty()) {
+				return;
+			}
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,117 @@
+#include "internal/support.hpp"
+#include <cthash/arena.hpp>
+#include <cthash/sha2/sha256.hpp>
+#include <cthash/sha2/sha512.hpp>
+#include <cthash/sha3/sha3-256.hpp>
+#include <cthash/sha3/shake128.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+using namespace cthash::literals;
+
+template <typename Hasher> constexpr bool interleaved_streams() {
+	std::array<std::byte, 300> input{};
+	for (int i = 0; i != (int)input.size(); ++i) {
+		input[i] = static_cast<std::byte>(i * 7);
+	}
+
+	constexpr size_t streams = 6u;
+
+	auto arena = cthash::hasher_arena<Hasher>{};
+	using request_t = typename decltype(arena)::update_request;
+
+	std::vector<typename decltype(arena)::handle> handles;
+	std::vector<Hasher> reference(streams);
+	std::vector<size_t> lengths(streams);
+
+	for (size_t i = 0; i != streams; ++i) {
+		handles.push_back(arena.open());
+	}
+
+	// chunks of different sizes, some streams are updated twice in one batch
+	for (size_t round = 0; round != 4u; ++round) {
+		std::vector<request_t> requests;
+
+		for (size_t i = 0; i != streams; ++i) {
+			const auto chunk = std::span<const std::byte>(input).first((i * 31u + round * 53u) % input.size());
+			requests.push_back(request_t{handles[i], chunk});
+			reference[i].update(chunk);
+			lengths[i] += chunk.size();
+
+			if ((i + round) % 4u == 0u) {
+				requests.push_back(request_t{handles[i], chunk.first(chunk.size() / 3u)});
+				reference[i].update(chunk.first(chunk.size() / 3u));
+				lengths[i] += chunk.size() / 3u;
+			}
+		}
+
+		arena.update(requests);
+	}
+
+	for (size_t i = 0; i != streams; ++i) {
+		if (arena.size(handles[i]) != lengths[i]) {
+			return false;
+		}
+	}
+
+	std::vector<typename Hasher::result_t> digests(streams);
+	arena.final(handles, std::span(digests));
+
+	for (size_t i = 0; i != streams; ++i) {
+		if (digests[i] != reference[i].final()) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+TEST_CASE("hasher_arena (constexpr)") {
+	STATIC_REQUIRE(interleaved_streams<cthash::sha256>());
+}
+
+TEST_CASE("hasher_arena (runtime)") {
+	REQUIRE(interleaved_streams<cthash::sha256>());
+	REQUIRE(interleaved_streams<cthash::sha512>());
+	REQUIRE(interleaved_streams<cthash::sha3_256>());
+}
+
+TEST_CASE("hasher_arena handles") {
+	auto arena = cthash::hasher_arena<cthash::sha256>{};
+
+	const auto a = arena.open();
+	const auto b = arena.open();
+	REQUIRE(arena.size() == 2u);
+	REQUIRE(a != b);
+
+	arena.update(a, std::as_bytes(std::span(std::string_view{"ha"})));
+	arena.update(b, std::as_bytes(std::span(std::string_view{"hello"})));
+	arena.update(a, std::as_bytes(std::span(std::string_view{"na"})));
+
+	REQUIRE(arena.size(a) == 4u);
+	REQUIRE(arena.final(a) == "599ba25a0d7c7d671bee93172ca7e272fc87f0c0e02e44df9e9436819067ea28"_sha256);
+
+	// stream is reset after final
+	REQUIRE(arena.size(a) == 0u);
+	REQUIRE(arena.final(a) == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"_sha256);
+
+	arena.close(b);
+	REQUIRE(arena.size() == 1u);
+	REQUIRE(!arena.contains(b));
+
+	// slot is reused with fresh state, but old handle stays invalid
+	const auto c = arena.open();
+	REQUIRE(c.index == b.index);
+	REQUIRE(c != b);
+	REQUIRE(arena.contains(c));
+	REQUIRE(!arena.contains(b));
+	REQUIRE(arena.size(c) == 0u);
+}
+
+TEST_CASE("hasher_arena with variable digest length") {
+	auto arena = cthash::hasher_arena<cthash::shake128>{};
+	const auto h = arena.open();
+	arena.update(h, std::as_bytes(std::span(std::string_view{"hello there!"})));
+
+	REQUIRE(arena.final<cthash::shake128_value<256>>(h) == "86089a77e15628597e45caf70c8ef271def6775c54d42d61fb45b9cd6d3b288e"_shake128);
+}
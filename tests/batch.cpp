@@ -0,0 +1,83 @@
+#include "internal/support.hpp"
+#include <cthash/batch.hpp>
+#include <cthash/sha2/sha256.hpp>
+#include <cthash/sha2/sha512.hpp>
+#include <cthash/sha3/sha3-256.hpp>
+#include <cthash/sha3/shake128.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+using namespace cthash::literals;
+
+template <typename Hasher> constexpr auto batch_of_prefixes() {
+	std::array<std::byte, 300> input{};
+	for (int i = 0; i != (int)input.size(); ++i) {
+		input[i] = static_cast<std::byte>(i);
+	}
+
+	// lengths around block boundaries (with and without space for padding)
+	constexpr auto lengths = std::array<size_t, 12>{0, 1, 55, 56, 63, 64, 65, 111, 112, 128, 200, 300};
+
+	std::array<std::span<const std::byte>, lengths.size()> in{};
+	for (size_t i = 0; i != lengths.size(); ++i) {
+		in[i] = std::span<const std::byte>(input).first(lengths[i]);
+	}
+
+	std::array<typename Hasher::result_t, lengths.size()> out{};
+	cthash::hash_many<Hasher>(in, out);
+
+	for (size_t i = 0; i != lengths.size(); ++i) {
+		if (out[i] != Hasher{}.update(in[i]).final()) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+TEST_CASE("hash_many (constexpr)") {
+	STATIC_REQUIRE(batch_of_prefixes<cthash::sha256>());
+	STATIC_REQUIRE(batch_of_prefixes<cthash::sha512>());
+	STATIC_REQUIRE(batch_of_prefixes<cthash::sha3_256>());
+}
+
+TEST_CASE("hash_many (runtime)") {
+	REQUIRE(batch_of_prefixes<cthash::sha256>());
+	REQUIRE(batch_of_prefixes<cthash::sha512>());
+	REQUIRE(batch_of_prefixes<cthash::sha3_256>());
+}
+
+TEST_CASE("hash_many with known values") {
+	const auto in = std::array<std::span<const std::byte>, 2>{std::as_bytes(std::span(std::string_view{"hana"})), std::span<const std::byte>{}};
+	auto out = std::array<cthash::sha256_value, 2>{};
+
+	cthash::hash_many<cthash::sha256>(in, out);
+
+	REQUIRE(out[0] == "599ba25a0d7c7d671bee93172ca7e272fc87f0c0e02e44df9e9436819067ea28"_sha256);
+	REQUIRE(out[1] == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"_sha256);
+}
+
+TEST_CASE("hash_many with different lengths than lanes") {
+	std::vector<std::vector<std::byte>> storage;
+	for (size_t i = 0; i != 100; ++i) {
+		storage.emplace_back((i * 37u) % 700u, static_cast<std::byte>(i));
+	}
+
+	const auto in = std::vector<std::span<const std::byte>>(storage.begin(), storage.end());
+	auto out = std::vector<cthash::sha256_value>(in.size());
+
+	cthash::hash_many<cthash::sha256>(in, out);
+
+	for (size_t i = 0; i != in.size(); ++i) {
+		REQUIRE(out[i] == cthash::sha256{}.update(in[i]).final());
+	}
+}
+
+TEST_CASE("hash_many with variable digest length") {
+	const auto in = std::array<std::span<const std::byte>, 1>{std::as_bytes(std::span(std::string_view{"hello there!"}))};
+	auto out = std::array<cthash::shake128_value<256>, 1>{};
+
+	cthash::hash_many<cthash::shake128>(in, std::span(out));
+
+	REQUIRE(out[0] == "86089a77e15628597e45caf70c8ef271def6775c54d42d61fb45b9cd6d3b288e"_shake128);
+}
@@ -0,0 +1,47 @@
+#include "../internal/support.hpp"
+#include <cthash/cdc.hpp>
+#include <cthash/sha2/sha256.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+TEST_CASE("content-defined chunking measurements") {
+	auto content = std::vector<std::byte>(16u * 1024u * 1024u);
+	auto rng = std::mt19937_64{42u};
+	for (auto & b: content) {
+		b = static_cast<std::byte>(rng());
+	}
+
+	BENCHMARK("sha256 of whole input (16 MiB)") {
+		return cthash::sha256{}.update(content).final();
+	};
+
+	BENCHMARK("fastcdc boundaries only (16 MiB)") {
+		const auto chunker = cthash::fastcdc{};
+		auto in = std::span<const std::byte>(content);
+		size_t count = 0u;
+		while (!in.empty()) {
+			in = in.subspan(chunker.cut(in, true));
+			++count;
+		}
+		return count;
+	};
+
+	BENCHMARK("fastcdc + sha256 of chunks (16 MiB)") {
+		return cthash::chunk_digests<cthash::sha256>(content).size();
+	};
+
+	BENCHMARK("fastcdc + sha256 of chunks, 4 KiB updates (16 MiB)") {
+		size_t count = 0u;
+		const auto emit = [&](const auto &) { ++count; };
+
+		auto h = cthash::chunked_hasher<cthash::sha256>{};
+		for (size_t offset = 0; offset < content.size(); offset += 4096u) {
+			h.update(std::span<const std::byte>(content).subspan(offset, std::min<size_t>(4096u, content.size() - offset)), emit);
+		}
+		h.final(emit);
+		return count;
+	};
+}
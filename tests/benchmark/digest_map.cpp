@@ -0,0 +1,47 @@
+#include "../internal/support.hpp"
+#include <cthash/digest_map.hpp>
+#include <cthash/sha2/sha256.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <unordered_map>
+#include <vector>
+
+TEST_CASE("digest_map measurements") {
+	std::vector<cthash::sha256_value> keys;
+	for (size_t i = 0; i != 1'000'000u; ++i) {
+		keys.push_back(cthash::simple<cthash::sha256>(std::string_view(reinterpret_cast<const char *>(&i), sizeof(i))));
+	}
+
+	auto map = cthash::digest_map<cthash::sha256_config, uint32_t>{keys.size()};
+	auto unordered = std::unordered_map<cthash::sha256_value, uint32_t>{};
+	unordered.reserve(keys.size());
+
+	for (size_t i = 0; i != keys.size(); ++i) {
+		map[keys[i]] = static_cast<uint32_t>(i);
+		unordered[keys[i]] = static_cast<uint32_t>(i);
+	}
+
+	BENCHMARK("std::unordered_map lookup (1M sha256)") {
+		uint64_t sum = 0u;
+		for (const auto & k: keys) {
+			sum += unordered.find(k)->second;
+		}
+		return sum;
+	};
+
+	BENCHMARK("digest_map lookup (1M sha256)") {
+		uint64_t sum = 0u;
+		for (const auto & k: keys) {
+			sum += map.find(k)->second;
+		}
+		return sum;
+	};
+
+	BENCHMARK("digest_map insert (1M sha256)") {
+		auto m = cthash::digest_map<cthash::sha256_config, uint32_t>{};
+		for (size_t i = 0; i != keys.size(); ++i) {
+			m[keys[i]] = static_cast<uint32_t>(i);
+		}
+		return m.size();
+	};
+}
@@ -0,0 +1,110 @@
+#include "../internal/support.hpp"
+#include <cthash/batch.hpp>
+#include <cthash/sha2/sha256.hpp>
+#include <cthash/sha3/sha3-256.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <numeric>
+#include <random>
+#include <vector>
+#include <cmath>
+
+namespace {
+
+struct records {
+	std::vector<std::byte> storage;
+	std::vector<std::span<const std::byte>> spans;
+
+	// record lengths follow log-normal distribution (most are short, some are few kB)
+	explicit records(size_t count, double median) {
+		auto rng = std::mt19937_64{42u};
+		auto dist = std::lognormal_distribution<double>{std::log(median), 1.0};
+
+		auto lengths = std::vector<size_t>(count);
+		for (auto & len: lengths) {
+			len = std::min<size_t>(static_cast<size_t>(dist(rng)), 16u * 1024u);
+		}
+
+		storage.resize(std::accumulate(lengths.begin(), lengths.end(), size_t{0}));
+		for (size_t i = 0; i != storage.size(); ++i) {
+			storage[i] = static_cast<std::byte>(i);
+		}
+
+		size_t offset = 0;
+		for (size_t len: lengths) {
+			spans.emplace_back(std::span<const std::byte>(storage).subspan(offset, len));
+			offset += len;
+		}
+	}
+};
+
+} // namespace
+
+TEST_CASE("hash_many measurements") {
+	const auto small = records(10'000, 64.0);
+	const auto medium = records(10'000, 512.0);
+	const auto large = records(10'000, 4096.0);
+
+	auto out256 = std::vector<cthash::sha256_value>(small.spans.size());
+	auto out3 = std::vector<cthash::sha3_256_value>(small.spans.size());
+
+	BENCHMARK("sha256 loop (median 64 B)") {
+		for (size_t i = 0; i != small.spans.size(); ++i) {
+			out256[i] = cthash::sha256{}.update(small.spans[i]).final();
+		}
+		return out256.back();
+	};
+
+	BENCHMARK("sha256 hash_many (median 64 B)") {
+		cthash::hash_many<cthash::sha256>(small.spans, out256);
+		return out256.back();
+	};
+
+	BENCHMARK("sha256 loop (median 512 B)") {
+		for (size_t i = 0; i != medium.spans.size(); ++i) {
+			out256[i] = cthash::sha256{}.update(medium.spans[i]).final();
+		}
+		return out256.back();
+	};
+
+	BENCHMARK("sha256 hash_many (median 512 B)") {
+		cthash::hash_many<cthash::sha256>(medium.spans, out256);
+		return out256.back();
+	};
+
+	BENCHMARK("sha3-256 loop (median 64 B)") {
+		for (size_t i = 0; i != small.spans.size(); ++i) {
+			out3[i] = cthash::sha3_256{}.update(small.spans[i]).final();
+		}
+		return out3.back();
+	};
+
+	BENCHMARK("sha3-256 hash_many (median 64 B)") {
+		cthash::hash_many<cthash::sha3_256>(small.spans, out3);
+		return out3.back();
+	};
+
+	BENCHMARK("sha3-256 loop (median 512 B)") {
+		for (size_t i = 0; i != medium.spans.size(); ++i) {
+			out3[i] = cthash::sha3_256{}.update(medium.spans[i]).final();
+		}
+		return out3.back();
+	};
+
+	BENCHMARK("sha3-256 hash_many (median 512 B)") {
+		cthash::hash_many<cthash::sha3_256>(medium.spans, out3);
+		return out3.back();
+	};
+
+	BENCHMARK("sha3-256 loop (median 4 kB)") {
+		for (size_t i = 0; i != large.spans.size(); ++i) {
+			out3[i] = cthash::sha3_256{}.update(large.spans[i]).final();
+		}
+		return out3.back();
+	};
+
+	BENCHMARK("sha3-256 hash_many (median 4 kB)") {
+		cthash::hash_many<cthash::sha3_256>(large.spans, out3);
+		return out3.back();
+	};
+}
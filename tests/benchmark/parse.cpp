@@ -0,0 +1,29 @@
+#include "../internal/support.hpp"
+#include <cthash/parse.hpp>
+#include <cthash/sha2/sha256.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+TEST_CASE("hexadecimal parsing measurements") {
+	std::string manifest;
+
+	for (size_t i = 0; i != 100'000u; ++i) {
+		std::array<char, 64> buffer{};
+		cthash::simple<cthash::sha256>(std::string_view(reinterpret_cast<const char *>(&i), sizeof(i))).to_hex(std::span(buffer));
+		manifest.append(buffer.begin(), buffer.end());
+		manifest += '\n';
+	}
+
+	BENCHMARK("parse_hashes (100k sha256 digests)") {
+		return cthash::parse_hashes<cthash::sha256_config>(manifest).values.size();
+	};
+
+	BENCHMARK("parse_hash one by one (100k sha256 digests)") {
+		size_t valid = 0u;
+		for (size_t offset = 0; offset < manifest.size(); offset += 65u) {
+			valid += cthash::parse_hash<cthash::sha256_config>(std::string_view(manifest).substr(offset, 64u)).has_value();
+		}
+		return valid;
+	};
+}
@@ -0,0 +1,115 @@
+#include "internal/support.hpp"
+#include <cthash/cdc.hpp>
+#include <cthash/sha2/sha256.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <vector>
+
+TEST_CASE("fastcdc boundaries") {
+	constexpr auto chunker = cthash::fastcdc{};
+
+	STATIC_REQUIRE(chunker.mask_small == 0xFFFE'0000'0000'0000ull);
+	STATIC_REQUIRE(chunker.mask_large == 0xFFE0'0000'0000'0000ull);
+
+	const auto content = random_content(1024u * 1024u);
+	auto in = std::span<const std::byte>(content);
+
+	size_t count = 0u;
+
+	while (!in.empty()) {
+		const size_t length = chunker.cut(in, true);
+
+		REQUIRE(length <= chunker.config.max_size);
+		REQUIRE((length >= chunker.config.min_size || length == in.size()));
+
+		in = in.subspan(length);
+		++count;
+	}
+
+	// normalized chunking keeps chunks around average size
+	REQUIRE(count > content.size() / (2u * chunker.config.avg_size));
+	REQUIRE(count < content.size() / (chunker.config.avg_size / 2u));
+
+	// content without boundaries is cut at maximal size
+	const auto zeros = std::vector<std::byte>(100'000u);
+	REQUIRE(chunker.cut(zeros) == chunker.config.max_size);
+
+	// not enough data to decide
+	REQUIRE(chunker.cut(std::span(content).first(1000u)) == 0u);
+	REQUIRE(chunker.cut(std::span(content).first(1000u), true) == 1000u);
+}
+
+TEST_CASE("fastcdc scan continues in appended data") {
+	constexpr auto chunker = cthash::fastcdc{};
+	const auto content = random_content(200'000u);
+
+	auto scan = cthash::cdc_scan{};
+	size_t size = 0u;
+	size_t length = 0u;
+
+	// boundary is found at the same place as when the whole prefix is scanned at once
+	while (length == 0u) {
+		size += 1000u;
+		const auto prefix = std::span(content).first(size);
+		length = chunker.cut(prefix, false, scan);
+		REQUIRE(length == chunker.cut(prefix));
+	}
+
+	REQUIRE(scan.position == 0u);
+	REQUIRE(length > chunker.config.min_size);
+}
+
+TEST_CASE("chunk_digests covers input") {
+	const auto content = random_content(300'000u);
+	const auto records = cthash::chunk_digests<cthash::sha256>(content);
+
+	REQUIRE(records.size() > 1u);
+
+	uint64_t offset = 0u;
+	for (const auto & r: records) {
+		REQUIRE(r.offset == offset);
+		REQUIRE(r.digest == cthash::simple<cthash::sha256>(std::span(content).subspan(r.offset, r.length)));
+		offset += r.length;
+	}
+
+	REQUIRE(offset == content.size());
+
+	REQUIRE(cthash::chunk_digests<cthash::sha256>({}).empty());
+}
+
+TEST_CASE("chunked_hasher streaming") {
+	const auto content = random_content(300'000u);
+	const auto expected = cthash::chunk_digests<cthash::sha256>(content);
+
+	for (size_t piece: {1u, 1000u, 4096u, 70'000u}) {
+		std::vector<cthash::chunk_record<cthash::sha256_value>> output;
+		const auto emit = [&](const auto & r) { output.push_back(r); };
+
+		auto h = cthash::chunked_hasher<cthash::sha256>{};
+
+		for (size_t offset = 0; offset < content.size(); offset += piece) {
+			h.update(std::span(content).subspan(offset, std::min(piece, content.size() - offset)), emit);
+		}
+
+		h.final(emit);
+
+		REQUIRE(output == expected);
+	}
+}
+
+TEST_CASE("chunk boundaries follow content") {
+	const auto content = random_content(500'000u);
+	auto shifted = random_content(100u, 2u);
+	shifted.insert(shifted.end(), content.begin(), content.end());
+
+	const auto lhs = cthash::chunk_digests<cthash::sha256>(content);
+	const auto rhs = cthash::chunk_digests<cthash::sha256>(shifted);
+
+	// only chunks around inserted bytes are different
+	size_t same = 0u;
+	for (const auto & r: rhs) {
+		same += static_cast<size_t>(std::any_of(lhs.begin(), lhs.end(), [&](const auto & l) { return l.digest == r.digest; }));
+	}
+
+	REQUIRE(same + 2u >= lhs.size());
+}
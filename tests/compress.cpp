@@ -0,0 +1,84 @@
+#include "internal/support.hpp"
+#include <cthash/sha2/compress.hpp>
+#include <cthash/sha2/sha256.hpp>
+#include <cthash/sha2/sha512.hpp>
+#include <cthash/sha3/keccak.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+using namespace cthash::literals;
+
+constexpr auto padded_hana() {
+	auto block = array_of_zeros<64>();
+	block[0] = std::byte{'h'};
+	block[1] = std::byte{'a'};
+	block[2] = std::byte{'n'};
+	block[3] = std::byte{'a'};
+	block[4] = std::byte{0b1000'0000u};
+	block[63] = std::byte{4u * 8u}; // length in bits
+	return block;
+}
+
+TEST_CASE("sha256 compress single block") {
+	constexpr auto r = [] {
+		auto state = cthash::sha2::initial_state<cthash::sha256_config>();
+		cthash::sha2::compress<cthash::sha256_config>(state, padded_hana());
+		return cthash::sha2::digest_of<cthash::sha256_config>(state);
+	}();
+
+	STATIC_REQUIRE(r == "599ba25a0d7c7d671bee93172ca7e272fc87f0c0e02e44df9e9436819067ea28"_sha256);
+}
+
+template <typename Config> constexpr bool batch_same_as_single() {
+	constexpr size_t block_size = cthash::sha2::block_size_of<Config>;
+
+	std::array<std::byte, block_size * 5u> input{};
+	for (size_t i = 0; i != input.size(); ++i) {
+		input[i] = static_cast<std::byte>(i * 3u);
+	}
+
+	std::array<cthash::sha2::state_of<Config>, 11> states{};
+	std::array<std::span<const std::byte>, 11> blocks{};
+
+	for (size_t i = 0; i != states.size(); ++i) {
+		states[i] = cthash::sha2::initial_state<Config>();
+		states[i][0] += i;
+		blocks[i] = std::span<const std::byte>(input).first((i % 6u) * block_size);
+	}
+
+	auto expected = states;
+	for (size_t i = 0; i != states.size(); ++i) {
+		cthash::sha2::compress<Config>(expected[i], blocks[i]);
+	}
+
+	cthash::sha2::compress<Config>(std::span(states), blocks);
+
+	return states == expected;
+}
+
+TEST_CASE("sha2 compress batch") {
+	STATIC_REQUIRE(batch_same_as_single<cthash::sha256_config>());
+	REQUIRE(batch_same_as_single<cthash::sha256_config>());
+	REQUIRE(batch_same_as_single<cthash::sha512_config>());
+}
+
+constexpr bool permute_batch_same_as_single() {
+	std::array<cthash::keccak::state_1600, 19> states{};
+	for (size_t i = 0; i != states.size(); ++i) {
+		states[i][i % 25u] = i;
+	}
+
+	auto expected = states;
+	for (auto & s: expected) {
+		cthash::keccak::permute(s);
+	}
+
+	cthash::keccak::permute(states);
+
+	return states == expected;
+}
+
+TEST_CASE("keccak permute batch") {
+	STATIC_REQUIRE(permute_batch_same_as_single());
+	REQUIRE(permute_batch_same_as_single());
+}
@@ -0,0 +1,102 @@
+#include "internal/support.hpp"
+#include <cthash/delta.hpp>
+#include <cthash/sha2/sha256.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+namespace {
+
+auto apply(std::span<const std::byte> old, std::span<const std::byte> data, std::span<const cthash::delta_op> ops) -> std::vector<std::byte> {
+	std::vector<std::byte> output;
+	for (const auto & op: ops) {
+		const auto source = op.copy ? old : data;
+		const auto part = source.subspan(static_cast<size_t>(op.offset), op.length);
+		output.insert(output.end(), part.begin(), part.end());
+	}
+	return output;
+}
+
+size_t copied(std::span<const cthash::delta_op> ops) {
+	size_t total = 0u;
+	for (const auto & op: ops) {
+		total += op.copy ? op.length : 0u;
+	}
+	return total;
+}
+
+} // namespace
+
+TEST_CASE("rolling_checksum") {
+	const auto content = random_content(10'000u);
+	constexpr size_t window = 700u;
+
+	auto weak = cthash::rolling_checksum(std::span(content).first(window));
+
+	for (size_t i = 1; i + window <= content.size(); ++i) {
+		weak.roll(content[i - 1u], content[i + window - 1u]);
+		REQUIRE(weak.value() == cthash::rolling_checksum(std::span(content).subspan(i, window)).value());
+	}
+}
+
+TEST_CASE("block signature") {
+	const auto content = random_content(100'000u);
+	const auto sig = cthash::make_signature<cthash::sha256>(content, 2048u);
+
+	REQUIRE(sig.size == content.size());
+	REQUIRE(sig.blocks.size() == 49u);
+
+	for (size_t i = 0; i != sig.blocks.size(); ++i) {
+		const auto block = std::span(content).subspan(i * 2048u, std::min<size_t>(2048u, content.size() - i * 2048u));
+		const auto digest = cthash::simple<cthash::sha256>(block);
+
+		REQUIRE(sig.blocks[i].weak == cthash::rolling_checksum(block).value());
+		REQUIRE(std::equal(sig.blocks[i].strong.begin(), sig.blocks[i].strong.end(), digest.begin()));
+	}
+}
+
+TEST_CASE("delta of changed file") {
+	const auto old = random_content(300'000u);
+	const auto sig = cthash::make_signature<cthash::sha256>(old, 1024u);
+	const auto matcher = cthash::delta_matcher<cthash::sha256>(sig);
+
+	SECTION("same file") {
+		const auto ops = matcher.match(old);
+		REQUIRE(ops == std::vector{cthash::delta_op{true, 0u, old.size()}});
+	}
+
+	SECTION("unrelated file") {
+		const auto other = random_content(50'000u, 2u);
+		const auto ops = matcher.match(other);
+		REQUIRE(ops == std::vector{cthash::delta_op{false, 0u, other.size()}});
+	}
+
+	SECTION("inserted, removed and modified bytes") {
+		auto changed = old;
+		changed.erase(changed.begin() + 200'000, changed.begin() + 200'100);
+		changed[100'000] ^= std::byte{1};
+		const auto extra = random_content(333u, 3u);
+		changed.insert(changed.begin() + 10'000, extra.begin(), extra.end());
+
+		const auto ops = matcher.match(changed);
+
+		REQUIRE(apply(old, changed, ops) == changed);
+		REQUIRE(copied(ops) >= changed.size() - 5u * 1024u);
+	}
+
+	SECTION("same weak checksum with different content") {
+		// s1 and s2 don't change
+		auto changed = old;
+		changed[5000] = static_cast<std::byte>(std::to_integer<unsigned>(changed[5000]) + 1u);
+		changed[5001] = static_cast<std::byte>(std::to_integer<unsigned>(changed[5001]) - 1u);
+		changed[5010] = static_cast<std::byte>(std::to_integer<unsigned>(changed[5010]) - 1u);
+		changed[5011] = static_cast<std::byte>(std::to_integer<unsigned>(changed[5011]) + 1u);
+
+		const auto block = std::span<const std::byte>(changed).subspan(4u * 1024u, 1024u);
+		REQUIRE(cthash::rolling_checksum(block).value() == sig.blocks[4].weak);
+
+		const auto ops = matcher.match(changed);
+
+		REQUIRE(apply(old, changed, ops) == changed);
+		REQUIRE(copied(ops) == changed.size() - 1024u);
+	}
+}
@@ -0,0 +1,127 @@
+#include "internal/support.hpp"
+#include <cthash/digest_map.hpp>
+#include <cthash/sha2/sha256.hpp>
+#include <cthash/sha3/sha3-224.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace cthash::literals;
+
+namespace {
+
+auto digest_of(size_t i) {
+	return cthash::simple<cthash::sha256>(std::string_view(reinterpret_cast<const char *>(&i), sizeof(i)));
+}
+
+constexpr bool small_set() {
+	auto set = cthash::digest_set<cthash::sha3_224_config>{};
+
+	for (int i = 0; i != 40; ++i) {
+		const auto input = std::array<std::byte, 1>{static_cast<std::byte>(i)};
+		set.insert(cthash::simple<cthash::sha3_224>(input));
+	}
+
+	const auto first = std::array<std::byte, 1>{std::byte{0}};
+	const auto missing = std::array<std::byte, 1>{std::byte{200}};
+
+	return set.size() == 40u && set.contains(cthash::simple<cthash::sha3_224>(first)) && !set.contains(cthash::simple<cthash::sha3_224>(missing));
+}
+
+} // namespace
+
+TEST_CASE("std::hash of digests") {
+	const auto v = "2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824"_sha256;
+	uint64_t expected;
+	std::memcpy(&expected, v.data(), sizeof(expected));
+
+	REQUIRE(std::hash<cthash::sha256_value>{}(v) == static_cast<size_t>(expected));
+
+	std::unordered_set<cthash::sha256_value> set;
+	for (size_t i = 0; i != 1000u; ++i) {
+		set.insert(digest_of(i));
+	}
+	REQUIRE(set.size() == 1000u);
+	REQUIRE(set.contains(digest_of(10u)));
+}
+
+TEST_CASE("digest_set") {
+	STATIC_REQUIRE(small_set());
+
+	auto set = cthash::digest_set<cthash::sha256_config>{};
+	REQUIRE(set.empty());
+	REQUIRE(!set.contains(digest_of(0u)));
+	REQUIRE(set.begin() == set.end());
+
+	for (size_t i = 0; i != 100'000u; ++i) {
+		REQUIRE(set.insert(digest_of(i)).second);
+	}
+
+	REQUIRE(!set.insert(digest_of(5u)).second);
+	REQUIRE(set.size() == 100'000u);
+	REQUIRE(set.size() * 8u <= set.capacity() * 7u);
+	REQUIRE(static_cast<size_t>(std::distance(set.begin(), set.end())) == set.size());
+
+	// erased half, other half is still there
+	for (size_t i = 0; i < 100'000u; i += 2u) {
+		REQUIRE(set.erase(digest_of(i)) == 1u);
+	}
+	REQUIRE(set.erase(digest_of(0u)) == 0u);
+
+	for (size_t i = 0; i != 100'000u; ++i) {
+		REQUIRE(set.contains(digest_of(i)) == (i % 2u == 1u));
+	}
+
+	// reuse of deleted slots
+	const size_t capacity = set.capacity();
+	for (int round = 0; round != 3; ++round) {
+		for (size_t i = 0; i < 100'000u; i += 2u) {
+			set.insert(digest_of(i));
+		}
+		for (size_t i = 0; i < 100'000u; i += 2u) {
+			set.erase(digest_of(i));
+		}
+	}
+
+	REQUIRE(set.capacity() == capacity);
+	REQUIRE(set.size() == 50'000u);
+	REQUIRE(*set.find(digest_of(1u)) == digest_of(1u));
+	REQUIRE(set.find(digest_of(2u)) == set.end());
+}
+
+TEST_CASE("digest_map") {
+	auto map = cthash::digest_map<cthash::sha256_config, std::string>{1000u};
+	REQUIRE(map.capacity() >= 1000u);
+	const size_t capacity = map.capacity();
+
+	for (size_t i = 0; i != 1000u; ++i) {
+		map[digest_of(i)] = std::to_string(i);
+	}
+
+	REQUIRE(map.capacity() == capacity);
+	REQUIRE(map.size() == 1000u);
+	REQUIRE(map.find(digest_of(77u))->second == "77");
+	REQUIRE(!map.try_emplace(digest_of(77u), "x").second);
+	REQUIRE(map.insert_or_assign(digest_of(77u), "x").second == false);
+	REQUIRE(map[digest_of(77u)] == "x");
+	REQUIRE(map.try_emplace(digest_of(1000u), 3u, 'a').second);
+	REQUIRE(map[digest_of(1000u)] == "aaa");
+
+	size_t total = 0u;
+	for (const auto & [key, value]: std::as_const(map)) {
+		REQUIRE(map.contains(key));
+		total += value.size();
+	}
+	REQUIRE(total > 1000u);
+
+	REQUIRE(map.erase(digest_of(77u)) == 1u);
+	REQUIRE(!map.contains(digest_of(77u)));
+	REQUIRE(map.size() == 1000u);
+
+	map.clear();
+	REQUIRE(map.empty());
+	REQUIRE(map.find(digest_of(1u)) == map.end());
+}
@@ -0,0 +1,126 @@
+#include "internal/support.hpp"
+#include <cthash/dual_digest.hpp>
+#include <cthash/sha2/sha256.hpp>
+#include <cthash/sha3/sha3-256.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+namespace {
+
+// pairs of (count, value), count zero is end of stream
+struct rle_decoder {
+	size_t run{0u};
+	size_t count{0u};
+	std::byte value{};
+	bool have_count{false};
+	bool end{false};
+
+	cthash::decode_step decode(std::span<const std::byte> in, std::span<std::byte> out) {
+		cthash::decode_step step{};
+
+		while (step.produced != out.size()) {
+			if (run != 0u) {
+				out[step.produced++] = value;
+				--run;
+				continue;
+			}
+
+			if (end || step.consumed == in.size()) {
+				break;
+			}
+
+			const std::byte b = in[step.consumed++];
+
+			if (have_count) {
+				value = b;
+				run = count;
+				have_count = false;
+			} else if (b == std::byte{0}) {
+				end = true;
+			} else {
+				count = std::to_integer<size_t>(b);
+				have_count = true;
+			}
+		}
+
+		return step;
+	}
+
+	bool finished() const noexcept {
+		return end && run == 0u;
+	}
+};
+
+auto rle_encode(std::span<const std::byte> data) -> std::vector<std::byte> {
+	std::vector<std::byte> output;
+
+	for (size_t i = 0; i != data.size();) {
+		size_t n = 1u;
+		while (i + n != data.size() && n != 255u && data[i + n] == data[i]) {
+			++n;
+		}
+		output.push_back(static_cast<std::byte>(n));
+		output.push_back(data[i]);
+		i += n;
+	}
+
+	output.push_back(std::byte{0});
+	return output;
+}
+
+auto test_content(size_t size) -> std::vector<std::byte> {
+	std::vector<std::byte> output(size);
+	for (size_t i = 0; i != size; ++i) {
+		output[i] = static_cast<std::byte>((i / 300u) * 7u);
+	}
+	return output;
+}
+
+} // namespace
+
+TEST_CASE("dual_digest of compressed and decompressed stream") {
+	const auto content = test_content(100'000u);
+	const auto encoded = rle_encode(content);
+
+	// small ring makes producer wait for consumer
+	for (size_t ring_size: {64u, 4096u, 1024u * 1024u}) {
+		for (size_t chunk_size: {1u, 333u, 100'000u}) {
+			auto h = cthash::dual_digest<cthash::sha256, cthash::sha3_256, rle_decoder>({}, {}, {}, ring_size);
+
+			for (size_t offset = 0; offset < encoded.size(); offset += chunk_size) {
+				REQUIRE(h.update(std::span(encoded).subspan(offset, std::min(chunk_size, encoded.size() - offset))));
+			}
+
+			const auto r = h.final();
+
+			REQUIRE(r.has_value());
+			REQUIRE(r->compressed == cthash::simple<cthash::sha256>(encoded));
+			REQUIRE(r->decompressed == cthash::simple<cthash::sha3_256>(content));
+			REQUIRE(r->compressed_size == encoded.size());
+			REQUIRE(r->decompressed_size == content.size());
+		}
+	}
+}
+
+TEST_CASE("dual_digest with broken stream") {
+	const auto content = test_content(10'000u);
+	auto encoded = rle_encode(content);
+
+	SECTION("truncated") {
+		auto h = cthash::dual_digest<cthash::sha256, cthash::sha256, rle_decoder>{};
+		REQUIRE(h.update(std::span(encoded).first(encoded.size() - 1u)));
+		REQUIRE(h.final() == std::nullopt);
+	}
+
+	SECTION("data after end") {
+		encoded.push_back(std::byte{1});
+		auto h = cthash::dual_digest<cthash::sha256, cthash::sha256, rle_decoder>{};
+		REQUIRE_FALSE(h.update(encoded));
+		REQUIRE(h.final() == std::nullopt);
+	}
+
+	SECTION("destroyed without final") {
+		auto h = cthash::dual_digest<cthash::sha256, cthash::sha256, rle_decoder>{};
+		REQUIRE(h.update(encoded));
+	}
+}
@@ -0,0 +1,177 @@
+#include <cthash/encoding.hpp>
+#include <cthash/sha2/sha256.hpp>
+#include <cthash/sha2/sha384.hpp>
+#include <cthash/sha3/sha3-224.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <string>
+
+using namespace cthash::literals;
+
+TEST_CASE("sri and base64 literals") {
+	// example from SRI specification
+	constexpr auto v1 = cthash::simple<cthash::sha384>(std::string_view("alert('Hello, world.');"));
+	constexpr auto v2 = "H8BRh8j48O9oYatfu5AZzq6A9RINhZO5H16dQZngK7T62em8MUt1FLm52t+eX6xO"_sha384_b64;
+
+	STATIC_REQUIRE(v1 == v2);
+	REQUIRE(cthash::sri(v1) == "sha384-H8BRh8j48O9oYatfu5AZzq6A9RINhZO5H16dQZngK7T62em8MUt1FLm52t+eX6xO");
+
+	constexpr auto hello = cthash::simple<cthash::sha256>(std::string_view("hello"));
+	STATIC_REQUIRE(hello == "LPJNul+wow4m6DsqxbninhsWHlwfp0JecwQzYpOLmCQ="_sha256_b64);
+	STATIC_REQUIRE(cthash::sri(hello) == "sha256-LPJNul+wow4m6DsqxbninhsWHlwfp0JecwQzYpOLmCQ=");
+}
+
+TEST_CASE("base64url and base32 literals") {
+	constexpr auto hello = cthash::simple<cthash::sha256>(std::string_view("hello"));
+
+	STATIC_REQUIRE(hello == "LPJNul-wow4m6DsqxbninhsWHlwfp0JecwQzYpOLmCQ"_sha256_b64url);
+	STATIC_REQUIRE(hello == "FTZE3OS7WCRQ4JXIHMVMLOPCTYNRMHS4D6TUEXTTAQZWFE4LTASA===="_sha256_b32);
+
+	constexpr auto v1 = cthash::simple<cthash::sha384>(std::string_view("alert('Hello, world.');"));
+	STATIC_REQUIRE(v1 == "H8BRh8j48O9oYatfu5AZzq6A9RINhZO5H16dQZngK7T62em8MUt1FLm52t-eX6xO"_sha384_b64url);
+}
+
+TEST_CASE("base64, base64url and base32 of digests") {
+	const auto v = cthash::simple<cthash::sha256>(std::string_view("hello"));
+
+	REQUIRE(cthash::to_base64(v) == "LPJNul+wow4m6DsqxbninhsWHlwfp0JecwQzYpOLmCQ=");
+	REQUIRE(cthash::to_base64url(v) == "LPJNul-wow4m6DsqxbninhsWHlwfp0JecwQzYpOLmCQ");
+	REQUIRE(cthash::to_base32(v) == "FTZE3OS7WCRQ4JXIHMVMLOPCTYNRMHS4D6TUEXTTAQZWFE4LTASA====");
+
+	REQUIRE(cthash::parse_base64<cthash::sha256_config>("LPJNul+wow4m6DsqxbninhsWHlwfp0JecwQzYpOLmCQ=").value() == v);
+	REQUIRE(cthash::parse_base64<cthash::sha256_config>("LPJNul+wow4m6DsqxbninhsWHlwfp0JecwQzYpOLmCQ").value() == v);
+	REQUIRE(cthash::parse_base64url<cthash::sha256_config>("LPJNul-wow4m6DsqxbninhsWHlwfp0JecwQzYpOLmCQ").value() == v);
+	REQUIRE(cthash::parse_base32<cthash::sha256_config>("FTZE3OS7WCRQ4JXIHMVMLOPCTYNRMHS4D6TUEXTTAQZWFE4LTASA====").value() == v);
+	REQUIRE(cthash::parse_base32<cthash::sha256_config>("ftze3os7wcrq4jxihmvmlopctynrmhs4d6tuexttaqzwfe4ltasa").value() == v);
+
+	using reason = cthash::parse_error_reason;
+
+	REQUIRE(cthash::parse_base64<cthash::sha256_config>("LPJNul-wow4m6DsqxbninhsWHlwfp0JecwQzYpOLmCQ=").error() == cthash::parse_error{reason::invalid_character, 6u});
+	REQUIRE(cthash::parse_base64<cthash::sha256_config>("LPJNul+wow4m6DsqxbninhsWHlwfp0JecwQzYpOLmC==").error() == cthash::parse_error{reason::invalid_character, 42u});
+	// non-canonical encoding with non-zero bits after the end of digest
+	REQUIRE(cthash::parse_base64<cthash::sha256_config>("LPJNul+wow4m6DsqxbninhsWHlwfp0JecwQzYpOLmCR=").error() == cthash::parse_error{reason::invalid_character, 42u});
+	REQUIRE(cthash::parse_base64url<cthash::sha256_config>("LPJNul-wow4m6DsqxbninhsWHlwfp0JecwQzYpOLmCT").error() == cthash::parse_error{reason::invalid_character, 42u});
+	REQUIRE(cthash::parse_base32<cthash::sha256_config>("FTZE3OS7WCRQ4JXIHMVMLOPCTYNRMHS4D6TUEXTTAQZWFE4LTASB====").error() == cthash::parse_error{reason::invalid_character, 51u});
+	REQUIRE(cthash::parse_base64<cthash::sha256_config>("LPJNul+wow4m6DsqxbninhsWHlwfp0JecwQzYpOLmCQ==").error() == cthash::parse_error{reason::invalid_length, 0u});
+	REQUIRE(cthash::parse_base32<cthash::sha256_config>("FTZE3OS7WCRQ4JXIHMVMLOPCTYNRMHS4D6TUEXTTAQZWFE4LTASA===").error() == cthash::parse_error{reason::invalid_length, 0u});
+
+	std::array<char, 44> buffer{};
+	REQUIRE(cthash::encode_into<cthash::base64_encoding>(v, buffer).size() == 44u);
+	REQUIRE(cthash::encode_into<cthash::base64_encoding>(v, std::span(buffer).first(43u)).empty());
+}
+
+TEST_CASE("base64 of all lengths") {
+	// lengths which use vectorized and scalar parts of encoder
+	std::array<std::byte, 64> input{};
+	for (size_t i = 0; i != input.size(); ++i) {
+		input[i] = static_cast<std::byte>(i * 97u + 5u);
+	}
+
+	for (size_t len = 0; len <= input.size(); ++len) {
+		const auto in = std::span<const std::byte>(input).first(len);
+
+		// reference bit by bit
+		std::string expected;
+		for (size_t bit = 0; bit < len * 8u; bit += 6u) {
+			unsigned v = 0u;
+			for (size_t i = bit; i != bit + 6u; ++i) {
+				v = (v << 1u) | ((i < len * 8u) ? ((std::to_integer<unsigned>(in[i / 8u]) >> (7u - i % 8u)) & 1u) : 0u);
+			}
+			expected += cthash::base64_encoding::alphabet[v];
+		}
+
+		std::string url = expected;
+		std::replace(url.begin(), url.end(), '+', '-');
+		std::replace(url.begin(), url.end(), '/', '_');
+
+		while (expected.size() % 4u != 0u) {
+			expected += '=';
+		}
+
+		std::string out(expected.size(), '?');
+		REQUIRE(cthash::internal::encode_into<cthash::base64_encoding>(in, out.data()) == expected.size());
+		REQUIRE(out == expected);
+
+		out.assign(url.size(), '?');
+		REQUIRE(cthash::internal::encode_into<cthash::base64url_encoding>(in, out.data()) == url.size());
+		REQUIRE(out == url);
+
+		std::array<std::byte, 64> decoded{};
+		REQUIRE(cthash::internal::decode_into<cthash::base64url_encoding>(url, decoded.data()) == url.size());
+		REQUIRE(std::equal(in.begin(), in.end(), decoded.begin()));
+
+		// flipping lowest bit of last character either changes data or sets unused bit
+		if (len % 3u != 0u) {
+			url.back() = cthash::base64url_encoding::alphabet[cthash::internal::decoding_table<cthash::base64url_encoding>[static_cast<unsigned char>(url.back())] ^ 1];
+			REQUIRE(cthash::internal::decode_into<cthash::base64url_encoding>(url, decoded.data()) == url.size() - 1u);
+		}
+	}
+}
+
+TEST_CASE("base32 of all lengths") {
+	std::array<std::byte, 64> input{};
+	for (size_t i = 0; i != input.size(); ++i) {
+		input[i] = static_cast<std::byte>(i * 97u + 5u);
+	}
+
+	for (size_t len = 0; len <= input.size(); ++len) {
+		const auto in = std::span<const std::byte>(input).first(len);
+
+		std::string expected;
+		for (size_t bit = 0; bit < len * 8u; bit += 5u) {
+			unsigned v = 0u;
+			for (size_t i = bit; i != bit + 5u; ++i) {
+				v = (v << 1u) | ((i < len * 8u) ? ((std::to_integer<unsigned>(in[i / 8u]) >> (7u - i % 8u)) & 1u) : 0u);
+			}
+			expected += cthash::base32_encoding::alphabet[v];
+		}
+
+		const size_t unpadded = expected.size();
+
+		while (expected.size() % 8u != 0u) {
+			expected += '=';
+		}
+
+		std::string out(expected.size(), '?');
+		REQUIRE(cthash::internal::encode_into<cthash::base32_encoding>(in, out.data()) == expected.size());
+		REQUIRE(out == expected);
+
+		std::array<std::byte, 64> decoded{};
+		const auto chars = std::string_view(expected).substr(0u, unpadded);
+		REQUIRE(cthash::internal::decode_into<cthash::base32_encoding>(chars, decoded.data()) == chars.size());
+		REQUIRE(std::equal(in.begin(), in.end(), decoded.begin()));
+	}
+}
+
+TEST_CASE("position of invalid character") {
+	std::array<std::byte, 64> input{};
+	for (size_t i = 0; i != input.size(); ++i) {
+		input[i] = static_cast<std::byte>(i * 31u + 7u);
+	}
+
+	std::string base64(86u, '?');
+	cthash::internal::encode_into<cthash::base64url_encoding>(input, base64.data());
+
+	std::string base32(104u, '?');
+	cthash::internal::encode_into<cthash::base32_encoding>(input, base32.data());
+	base32.resize(103u); // without padding
+
+	std::array<std::byte, 64> decoded{};
+
+	// every position in vectorized and scalar parts of decoder, with characters of the other alphabet and non-ASCII
+	for (char invalid: {'+', '/', '=', '.', '\x80', '\xC1'}) {
+		for (size_t i = 0; i != base64.size(); ++i) {
+			auto copy = base64;
+			copy[i] = invalid;
+			REQUIRE(cthash::internal::decode_into<cthash::base64url_encoding>(copy, decoded.data()) == i);
+		}
+	}
+
+	for (char invalid: {'0', '1', '8', '=', '\x80', '\xC1'}) {
+		for (size_t i = 0; i != base32.size(); ++i) {
+			auto copy = base32;
+			copy[i] = invalid;
+			REQUIRE(cthash::internal::decode_into<cthash::base32_encoding>(copy, decoded.data()) == i);
+		}
+	}
+}
@@ -1,5 +1,7 @@
 #include <cthash/internal/hexdec.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <string>
 
 TEST_CASE("hexdec basics") {
 	constexpr auto v1 = cthash::internal::literal_hexdec_to_binary("");
@@ -22,4 +24,57 @@ TEST_CASE("hexdec conversion") {
 
 	auto b = cthash::internal::literal_hexdec_to_binary(runtime_pass("ab"));
 	REQUIRE((b == std::array<std::byte, 1>{std::byte{0xab}}));
-}
\ No newline at end of file
+}
+
+TEST_CASE("hexdec encoding") {
+	std::array<std::byte, 100> input{};
+	for (size_t i = 0; i != input.size(); ++i) {
+		input[i] = static_cast<std::byte>(i * 37u + 11u);
+	}
+
+	// all lengths go through all (vectorized and scalar) parts of encoder
+	for (size_t len = 0; len <= input.size(); ++len) {
+		const auto in = std::span<const std::byte>(input).first(len);
+
+		std::string expected;
+		std::string expected_upper;
+		for (std::byte b: in) {
+			expected += cthash::internal::value_to_hexdec_alphabet<char>[unsigned(b) >> 4u];
+			expected += cthash::internal::value_to_hexdec_alphabet<char>[unsigned(b) & 0xFu];
+			expected_upper += cthash::internal::value_to_upper_hexdec_alphabet<char>[unsigned(b) >> 4u];
+			expected_upper += cthash::internal::value_to_upper_hexdec_alphabet<char>[unsigned(b) & 0xFu];
+		}
+
+		std::string out(len * 2u, '?');
+		cthash::internal::encode_hexdec(in, out.data());
+		REQUIRE(out == expected);
+
+		cthash::internal::encode_hexdec(in, out.data(), true);
+		REQUIRE(out == expected_upper);
+
+		std::u8string out8(len * 2u, u8'?');
+		cthash::internal::encode_hexdec(in, out8.data());
+		REQUIRE(std::equal(out8.begin(), out8.end(), expected.begin(), expected.end()));
+
+		std::wstring wide(len * 2u, L'?');
+		cthash::internal::encode_hexdec(in, wide.data());
+		REQUIRE(std::equal(wide.begin(), wide.end(), expected.begin(), expected.end()));
+	}
+}
+
+TEST_CASE("hexdec decoding of odd length") {
+	std::array<std::byte, 32> out{};
+
+	REQUIRE(cthash::internal::decode_hexdec(std::span<const char>(std::string_view("a")), out.data()) == 0u);
+	REQUIRE(cthash::internal::decode_hexdec(std::span<const char>(std::string_view("abc")), out.data()) == 2u);
+	REQUIRE(out[0] == std::byte{0xab});
+
+	// long enough for vectorized parts, unpaired character is reported even when it's a valid digit
+	const auto valid = std::string(41u, 'f');
+	REQUIRE(cthash::internal::decode_hexdec(std::span<const char>(valid), out.data()) == 40u);
+	REQUIRE(std::all_of(out.begin(), out.begin() + 20, [](std::byte b) { return b == std::byte{0xff}; }));
+
+	auto invalid = valid;
+	invalid[17] = 'x';
+	REQUIRE(cthash::internal::decode_hexdec(std::span<const char>(invalid), out.data()) == 17u);
+}
@@ -2,9 +2,12 @@
 #define CTHASH_TESTS_INTERNAL_SUPPORT_HPP
 
 #include <array>
+#include <random>
 #include <span>
 #include <string_view>
+#include <vector>
 #include <cstddef>
+#include <cstdint>
 
 template <typename T> const auto & runtime_pass(const T & val) {
 	return val;
@@ -32,4 +35,13 @@ template <size_t N> constexpr auto to_str(const std::array<char, N> & in) {
 	return std::string{in.data(), in.size()};
 }
 
+inline auto random_content(size_t size, uint64_t seed = 1u) -> std::vector<std::byte> {
+	auto rng = std::mt19937_64{seed};
+	std::vector<std::byte> output(size);
+	for (auto & b: output) {
+		b = static_cast<std::byte>(rng());
+	}
+	return output;
+}
+
 #endif
@@ -0,0 +1,87 @@
+#include "internal/support.hpp"
+#include <cthash/job_manager.hpp>
+#include <cthash/sha2/sha256.hpp>
+#include <cthash/sha2/sha512.hpp>
+#include <cthash/sha3/sha3-256.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+using namespace cthash::literals;
+
+template <typename Hasher> constexpr bool submit_and_flush_all() {
+	std::array<std::byte, 300> input{};
+	for (int i = 0; i != (int)input.size(); ++i) {
+		input[i] = static_cast<std::byte>(i);
+	}
+
+	auto manager = cthash::job_manager<Hasher>{};
+	std::array<typename decltype(manager)::job_t, 12> jobs{};
+	std::array<bool, 12> returned{};
+
+	const auto check = [&](auto * job) {
+		if (job == nullptr) {
+			return true;
+		}
+		const auto idx = static_cast<size_t>(job - jobs.data());
+		if (returned[idx]) {
+			return false;
+		}
+		returned[idx] = true;
+		return job->digest == Hasher{}.update(job->input).final();
+	};
+
+	for (size_t i = 0; i != jobs.size(); ++i) {
+		jobs[i].input = std::span<const std::byte>(input).first((i * 97u) % input.size());
+		if (!check(manager.submit(jobs[i]))) {
+			return false;
+		}
+	}
+
+	while (auto * job = manager.flush()) {
+		if (!check(job)) {
+			return false;
+		}
+	}
+
+	return manager.empty() && std::all_of(returned.begin(), returned.end(), [](bool v) { return v; });
+}
+
+TEST_CASE("job_manager (constexpr)") {
+	STATIC_REQUIRE(submit_and_flush_all<cthash::sha256>());
+	STATIC_REQUIRE(submit_and_flush_all<cthash::sha3_256>());
+}
+
+TEST_CASE("job_manager (runtime)") {
+	REQUIRE(submit_and_flush_all<cthash::sha256>());
+	REQUIRE(submit_and_flush_all<cthash::sha512>());
+	REQUIRE(submit_and_flush_all<cthash::sha3_256>());
+}
+
+// multi-lane manager waits for more jobs, single lane one finishes every job in submit
+template <typename Hasher> bool submit_one_and_flush() {
+	using manager_t = cthash::job_manager<Hasher>;
+
+	auto manager = manager_t{};
+	auto job = typename manager_t::job_t{std::as_bytes(std::span(std::string_view{"hana"}))};
+
+	if constexpr (manager_t::lanes > 1u) {
+		REQUIRE(manager.submit(job) == nullptr);
+		REQUIRE(manager.size() == 1u);
+		REQUIRE(manager.flush() == &job);
+	} else {
+		REQUIRE(manager.submit(job) == &job);
+	}
+
+	REQUIRE(manager.flush() == nullptr);
+	REQUIRE(manager.empty());
+	return job.digest == Hasher{}.update(job.input).final();
+}
+
+TEST_CASE("job_manager returns jobs only when lanes are full") {
+	STATIC_REQUIRE(cthash::job_manager<cthash::sha256>::lanes > 1u);
+	STATIC_REQUIRE(cthash::job_manager<cthash::sha3_256>::lanes == 1u);
+
+	REQUIRE(submit_one_and_flush<cthash::sha256>());
+	REQUIRE(submit_one_and_flush<cthash::sha3_256>());
+	REQUIRE(cthash::sha256{}.update("hana").final() == "599ba25a0d7c7d671bee93172ca7e272fc87f0c0e02e44df9e9436819067ea28"_sha256);
+}
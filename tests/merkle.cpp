@@ -0,0 +1,142 @@
+#include "internal/support.hpp"
+#include <cthash/merkle.hpp>
+#include <cthash/sha2/sha256.hpp>
+#include <cthash/sha3/sha3-256.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+namespace {
+
+// straightforward recursive definition from RFC 6962 (MTH)
+template <typename Hasher> auto reference_tree(std::span<const std::byte> in, size_t leaf_size) -> typename Hasher::result_t {
+	if (in.empty()) {
+		return Hasher{}.final();
+	}
+
+	if (in.size() <= leaf_size) {
+		return Hasher{}.update(std::span(cthash::merkle_hasher<Hasher>::leaf_prefix)).update(in).final();
+	}
+
+	// left subtree has largest power of two of leaves smaller than all leaves
+	const size_t count = (in.size() + leaf_size - 1u) / leaf_size;
+	const size_t left = std::bit_floor(count - 1u) * leaf_size;
+
+	const auto lhs = reference_tree<Hasher>(in.first(left), leaf_size);
+	const auto rhs = reference_tree<Hasher>(in.subspan(left), leaf_size);
+
+	return Hasher{}.update(std::span(cthash::merkle_hasher<Hasher>::node_prefix)).update(std::span<const std::byte>(lhs)).update(std::span<const std::byte>(rhs)).final();
+}
+
+// data with long zero runs
+auto sparse_content(size_t size) -> std::vector<std::byte> {
+	std::vector<std::byte> output(size);
+	for (size_t i = 0; i != size; ++i) {
+		if ((i / 1000u) % 5u == 0u) {
+			output[i] = static_cast<std::byte>(i * 7u + 1u);
+		}
+	}
+	return output;
+}
+
+} // namespace
+
+TEST_CASE("merkle_hasher (constexpr)") {
+	constexpr auto empty = cthash::merkle_hasher<cthash::sha256>{64u}.final();
+	STATIC_REQUIRE(empty == cthash::sha256{}.final());
+
+	constexpr auto zeros = [] {
+		auto h = cthash::merkle_hasher<cthash::sha256>{64u};
+		h.update_zeros(64u * 5u + 3u);
+		return h.final();
+	}();
+
+	constexpr auto explicit_zeros = [] {
+		std::array<std::byte, 64u * 5u + 3u> data{};
+		return cthash::merkle_hasher<cthash::sha256>{64u}.update(data).final();
+	}();
+
+	STATIC_REQUIRE(zeros == explicit_zeros);
+}
+
+TEST_CASE("merkle_hasher matches RFC 6962 tree") {
+	const auto content = sparse_content(70'000u);
+
+	for (size_t leaf_size: {64u, 1000u, 4096u}) {
+		for (size_t size: {0u, 1u, 63u, 64u, 65u, 4096u, 12'345u, 70'000u}) {
+			const auto input = std::span(content).first(size);
+
+			auto h = cthash::merkle_hasher<cthash::sha256>{leaf_size};
+			h.update(input);
+
+			REQUIRE(h.final() == reference_tree<cthash::sha256>(input, leaf_size));
+		}
+	}
+}
+
+TEST_CASE("merkle_hasher with input in pieces") {
+	const auto content = sparse_content(50'000u);
+	const auto expected = reference_tree<cthash::sha3_256>(content, 512u);
+
+	for (size_t chunk: {1u, 100u, 512u, 3000u}) {
+		auto h = cthash::merkle_hasher<cthash::sha3_256>{512u};
+
+		for (size_t offset = 0; offset < content.size(); offset += chunk) {
+			h.update(std::span(content).subspan(offset, std::min(chunk, content.size() - offset)));
+		}
+
+		REQUIRE(h.final() == expected);
+	}
+}
+
+TEST_CASE("merkle_hasher zero runs") {
+	constexpr size_t leaf_size = 256u;
+
+	// data, hole, data, long hole and partial leaf
+	const std::vector<std::pair<size_t, size_t>> layout = {{300u, 0u}, {0u, 5000u}, {1024u, 0u}, {0u, 256u * 1000u + 17u}, {10u, 0u}};
+
+	std::vector<std::byte> flat;
+	auto h = cthash::merkle_hasher<cthash::sha256>{leaf_size};
+
+	for (const auto & [data, hole]: layout) {
+		std::vector<std::byte> part(data, std::byte{0xAB});
+		h.update(part);
+		h.update_zeros(hole);
+
+		flat.insert(flat.end(), part.begin(), part.end());
+		flat.insert(flat.end(), hole, std::byte{0});
+	}
+
+	REQUIRE(h.final() == reference_tree<cthash::sha256>(flat, leaf_size));
+	REQUIRE(h.zero_leaves >= 1000u);
+}
+
+TEST_CASE("merkle_hasher many zero leaves") {
+	auto h = cthash::merkle_hasher<cthash::sha256>{4096u};
+	h.update_zeros(uint64_t{1} << 40u); // 1 TiB hole is just a few hashes
+
+	auto r = cthash::merkle_hasher<cthash::sha256>{4096u};
+	r.update_zeros(4096u);
+	auto leaf = r.final();
+
+	// 2^28 leaves form perfect tree of zero subtrees
+	for (int i = 0; i != 28; ++i) {
+		leaf = cthash::sha256{}.update(std::span(cthash::merkle_hasher<cthash::sha256>::node_prefix)).update(std::span<const std::byte>(leaf)).update(std::span<const std::byte>(leaf)).final();
+	}
+
+	REQUIRE(h.final() == leaf);
+}
+
+TEST_CASE("merkle_hasher with shared zero subtrees") {
+	const auto zeros = cthash::merkle_zero_subtrees<cthash::sha256>{512u};
+	const auto content = sparse_content(40'000u);
+
+	auto shared = cthash::merkle_hasher<cthash::sha256>{zeros};
+	shared.update(content).update_zeros(uint64_t{1} << 30u);
+
+	auto own = cthash::merkle_hasher<cthash::sha256>{512u};
+	own.update(content).update_zeros(uint64_t{1} << 30u);
+
+	REQUIRE(shared.leaf_size == 512u);
+	REQUIRE(shared.final() == own.final());
+	REQUIRE(zeros.digests[3] == own.zero[3]);
+}
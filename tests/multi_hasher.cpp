@@ -0,0 +1,41 @@
+#include "internal/support.hpp"
+#include <cthash/multi_hasher.hpp>
+#include <cthash/sha2/sha256.hpp>
+#include <cthash/sha2/sha512.hpp>
+#include <cthash/sha3/sha3-256.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+using namespace cthash::literals;
+
+TEST_CASE("multi_hasher (constexpr)") {
+	constexpr auto r = cthash::multi_hasher<cthash::sha256, cthash::sha3_256>{}.update("hello there!").final();
+
+	STATIC_REQUIRE(std::get<0>(r) == "c69509590d81db2f37f9d75480c8efedf79a77933db5a8319e52e13bfd9874a3"_sha256);
+	STATIC_REQUIRE(std::get<1>(r) == "c7fd85f649fba4bd6fb605038ae8530cf2239152bbbcb9d91d260cc2a90a9fea"_sha3_256);
+}
+
+TEST_CASE("multi_hasher basics") {
+	auto h = cthash::multi_hasher<cthash::sha256, cthash::sha512, cthash::sha3_256>{};
+	h.update(runtime_pass("ha"));
+	h.update(runtime_pass("na"));
+	REQUIRE(h.size() == 4u);
+
+	const auto [a, b, c] = h.final();
+
+	REQUIRE(a == "599ba25a0d7c7d671bee93172ca7e272fc87f0c0e02e44df9e9436819067ea28"_sha256);
+	REQUIRE(b == cthash::simple<cthash::sha512>(runtime_pass("hana")));
+	REQUIRE(c == cthash::simple<cthash::sha3_256>(runtime_pass("hana")));
+}
+
+TEST_CASE("multi_hasher over multiple tiles") {
+	auto input = std::vector<std::byte>(cthash::multi_hasher_tile_size * 3u + 1234u);
+	for (size_t i = 0; i != input.size(); ++i) {
+		input[i] = static_cast<std::byte>(i * 13u);
+	}
+
+	const auto [a, b] = cthash::multi_hasher<cthash::sha256, cthash::sha3_256>{}.update(input).final();
+
+	REQUIRE(a == cthash::simple<cthash::sha256>(input));
+	REQUIRE(b == cthash::simple<cthash::sha3_256>(input));
+}
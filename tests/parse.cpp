@@ -0,0 +1,68 @@
+#include <cthash/parse.hpp>
+#include <cthash/sha2/sha256.hpp>
+#include <cthash/sha3/sha3-512.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+using namespace cthash::literals;
+
+TEST_CASE("parse_hash") {
+	constexpr auto r1 = cthash::parse_hash<cthash::sha256_config>("2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824");
+	STATIC_REQUIRE(r1.has_value());
+	STATIC_REQUIRE(*r1 == "2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824"_sha256);
+
+	const auto r2 = cthash::parse_hash<cthash::sha256_config>(std::string("2CF24DBA5FB0A30E26E83B2AC5B9E29E1B161E5C1FA7425E73043362938B9824"));
+	REQUIRE(r2);
+	REQUIRE(r2.value() == r1.value());
+
+	const auto r3 = cthash::parse_hash<cthash::sha256_config>("2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b982");
+	REQUIRE(!r3);
+	REQUIRE(r3.error() == cthash::parse_error{cthash::parse_error_reason::invalid_length, 0u});
+
+	// invalid character at every position is found by every part of decoder
+	const std::string valid(128u, 'a');
+	for (size_t i = 0; i != valid.size(); ++i) {
+		for (char c: {'g', 'G', '/', ':', '@', '`', ' ', '\x80', '\xe1'}) {
+			auto broken = valid;
+			broken[i] = c;
+
+			const auto r = cthash::parse_hash<cthash::sha3_512_config>(broken);
+			REQUIRE(!r.has_value());
+			REQUIRE(r.error() == cthash::parse_error{cthash::parse_error_reason::invalid_character, i});
+		}
+	}
+}
+
+TEST_CASE("parse_hash of all characters") {
+	const auto digest = cthash::simple<cthash::sha3_512>(std::string_view("hello"));
+
+	std::string hex;
+	for (size_t i = 0; i != 4u; ++i) {
+		std::array<char, 128> buffer{};
+		digest.to_hex(std::span(buffer), i % 2u == 1u);
+		hex.assign(buffer.begin(), buffer.end());
+
+		REQUIRE(cthash::parse_hash<cthash::sha3_512_config>(hex).value() == digest);
+	}
+}
+
+TEST_CASE("parse_hashes") {
+	const auto input = std::string("2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824\n"
+								   "\n"
+								   "486ea46224d1bb4fb680f34f7c9ad96a8f24ec88be73ea8e5a6c65260e9cb8a7\r\n"
+								   "486ea46224d1bb4fb680f34f7c9ad96a8f24ec88be73ea8e5a6c65260e9cb8a\n"
+								   "486ea46224d1bb4fb680f34f7c9ad96a8f24ec88be73ea8e5a6c65260e9cbxa7\n"
+								   "0000000000000000000000000000000000000000000000000000000000000000");
+
+	const auto r = cthash::parse_hashes<cthash::sha256_config>(input);
+
+	REQUIRE(r.values.size() == 3u);
+	REQUIRE(r.values[0] == "2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824"_sha256);
+	REQUIRE(r.values[1] == "486ea46224d1bb4fb680f34f7c9ad96a8f24ec88be73ea8e5a6c65260e9cb8a7"_sha256);
+	REQUIRE(r.values[2] == cthash::sha256_value{});
+
+	REQUIRE(!r.ok());
+	REQUIRE(r.errors.size() == 2u);
+	REQUIRE(r.errors[0] == cthash::parse_error{cthash::parse_error_reason::invalid_length, 132u});
+	REQUIRE(r.errors[1] == cthash::parse_error{cthash::parse_error_reason::invalid_character, 196u + 61u});
+}
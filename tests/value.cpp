@@ -1,4 +1,5 @@
 #include <cthash/value.hpp>
+#include <cthash/sha2/sha256.hpp>
 #include <sstream>
 #include <catch2/catch_test_macros.hpp>
 
@@ -60,3 +61,84 @@ TEST_CASE("hash stringification") {
 	auto v1 = cthash::hash_value{"00112233aabbccdd"};
 	REQUIRE(convert_to_string(v1) == "00112233aabbccdd");
 }
+
+TEST_CASE("hash to_chars and to_hex") {
+	constexpr auto v1 = cthash::hash_value{"00112233aabbccdd"};
+
+	constexpr auto hex = [&] {
+		std::array<char, 16> buffer{};
+		v1.to_hex(std::span(buffer));
+		return buffer;
+	}();
+
+	STATIC_REQUIRE(std::string_view(hex.data(), hex.size()) == "00112233aabbccdd");
+
+	std::array<char, 20> buffer{};
+	const auto written = v1.to_hex(std::span(buffer), true);
+	REQUIRE(std::string_view(written.data(), written.size()) == "00112233AABBCCDD");
+	REQUIRE(v1.to_hex(std::span(buffer).first(15)).empty());
+
+	const auto [ptr, ec] = to_chars(buffer.data(), buffer.data() + buffer.size(), v1);
+	REQUIRE(ec == std::errc{});
+	REQUIRE(std::string_view(buffer.data(), ptr) == "00112233aabbccdd");
+
+	const auto r = to_chars(buffer.data(), buffer.data() + 10, v1);
+	REQUIRE(r.ec == std::errc::value_too_large);
+
+	const auto digest = cthash::simple<cthash::sha256>(std::string_view("hello"));
+	REQUIRE(convert_to_string(digest) == "2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824");
+}
+
+#if __cpp_lib_format >= 201907L
+TEST_CASE("hash std::format") {
+	const auto v1 = cthash::hash_value{"00112233aabbccdd"};
+	REQUIRE(std::format("{}", v1) == "00112233aabbccdd");
+	REQUIRE(std::format("{:X}", v1) == "00112233AABBCCDD");
+
+	const auto digest = cthash::simple<cthash::sha256>(std::string_view("hello"));
+	REQUIRE(std::format("{:x}", digest) == "2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824");
+}
+#endif
+
+TEST_CASE("hash_value comparison") {
+	constexpr auto v1 = cthash::hash_value{"00112233445566778899aabbccddeeff0011"};
+	constexpr auto v2 = cthash::hash_value{"00112233445566778899aabbccddeeff0012"};
+
+	STATIC_REQUIRE(v1 < v2);
+	STATIC_REQUIRE(v1 != v2);
+	STATIC_REQUIRE(cthash::verify_equal(v1, v1));
+	STATIC_REQUIRE(!cthash::verify_equal(v1, v2));
+
+	// difference in each byte (in words and in tail), order must be lexicographic
+	cthash::hash_value<20> a{};
+	for (size_t i = 0; i != a.size(); ++i) {
+		a[i] = static_cast<std::byte>(0x10u + i);
+	}
+
+	for (size_t i = 0; i != a.size(); ++i) {
+		for (unsigned delta: {1u, 0x80u}) {
+			auto b = a;
+			b[i] = static_cast<std::byte>(std::to_integer<unsigned>(b[i]) + delta);
+
+			REQUIRE(a != b);
+			REQUIRE(a < b);
+			REQUIRE(b > a);
+			REQUIRE(!cthash::verify_equal(a, b));
+
+			// later bytes don't matter
+			for (size_t j = i + 1u; j != a.size(); ++j) {
+				b[j] = std::byte{0};
+			}
+			REQUIRE(a < b);
+		}
+	}
+
+	auto c = a;
+	REQUIRE(a == c);
+	REQUIRE((a <=> c) == 0);
+	REQUIRE(cthash::verify_equal(a, c));
+
+	const auto d1 = cthash::simple<cthash::sha256>(std::string_view("hello"));
+	const auto d2 = cthash::simple<cthash::sha256>(std::string_view("hello"));
+	REQUIRE(cthash::verify_equal(d1, d2));
+}